@@ -0,0 +1,54 @@
+#include <libppc.h>
+
+#include <stdlib.h>
+
+#include <stdio.h>
+
+#include <omp.h>
+
+int main(){
+
+    omp_set_num_threads( 4 );
+
+    double *v1 = allocate_double_vector_first_touch( 100000 );
+
+    if ( v1 == NULL )
+        return 1;
+
+    for ( long int i = 0; i < 100000; i++ ){
+
+        if ( v1[ i ] != 0.0 )
+            return 2;
+
+        v1[ i ] = (double)i;
+    }
+
+    double *v2 = copy_double_vector_first_touch( v1, 100000 );
+
+    if ( compare_double_vectors( v1, v2, 100000 ) != 0 )
+        return 3;
+
+    save_double_vector( v1, 100000, "first_touch.test.input" );
+
+    double *v3 = load_double_vector_first_touch( "first_touch.test.input", 100000 );
+
+    if ( v3 == NULL || compare_double_vectors( v1, v3, 100000 ) != 0 )
+        return 4;
+
+    if ( parse_bind_policy( "scatter" ) != BIND_SCATTER || parse_bind_policy( "foo" ) != -1 )
+        return 5;
+
+    if ( bind_omp_threads( BIND_COMPACT ) != 0 )
+        return 6;
+
+    if ( bind_omp_threads( BIND_NONE ) != 0 )
+        return 7;
+
+    print_numa_placement( v3, sizeof(double) * 100000, "v3" );
+
+    free( v1 );
+    free( v2 );
+    free( v3 );
+
+    return 0;
+}
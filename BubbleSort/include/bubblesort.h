@@ -0,0 +1,137 @@
+#ifndef __BUBBLESORT_H__
+
+#define __BUBBLESORT_H__
+
+#include <stddef.h>
+#include <libppc.h>
+
+/**
+	\brief Bubble sort clássico: passadas até nenhuma troca acontecer
+*/
+void BubbleSort_serial(double *array, long int size);
+
+/**
+	\brief Ordenação por transposição par-ímpar, elemento a elemento
+*/
+void BubbleSort_parallel(double *array, long int size);
+
+/**
+	\brief Estatísticas de uma execução das variantes par-ímpar
+*/
+typedef struct {
+
+	// Rodadas (fase par + fase ímpar) até a convergência
+	long int rounds;
+
+	// Médias por thread: tempo nos laços de comparação e troca e tempo
+	// esperando nas barreiras
+	double work_time;
+	double sync_time;
+
+	// Tamanho médio da janela ativa dividido por N (1.0 sem janela)
+	double active_fraction;
+
+} odd_even_statistics_t;
+
+/**
+	\brief Transposição par-ímpar numa única região paralela
+
+	Mesmo algoritmo de BubbleSort_parallel, mas a região paralela é criada
+	uma vez só: cada thread compara e troca uma faixa fixa de pares em cada
+	fase, as fases são separadas por barreiras e a convergência é uma flag
+	compartilhada em três posições alternadas, sem reduction e com uma
+	barreira por fase.
+
+	\param statistics preenchido se não for NULL
+*/
+void BubbleSort_persistent(double *array, long int size, odd_even_statistics_t *statistics);
+
+/**
+	\brief Transposição par-ímpar com janela ativa adaptativa
+
+	O vetor é dividido em blocos de ADAPTIVE_CHUNK elementos, repartidos
+	entre as threads em faixas fixas, e cada bloco tem uma flag de troca por
+	rodada. Um bloco em que nem ele nem os dois vizinhos trocaram na rodada
+	anterior já está estável e é pulado; os blocos voltam a ser percorridos
+	quando uma troca chega a um vizinho. Termina quando uma rodada não troca
+	nada. active_fraction é a fração média do vetor percorrida por rodada.
+*/
+void BubbleSort_adaptive(double *array, long int size, odd_even_statistics_t *statistics);
+
+// Conjuntos de instruções aceitos por BubbleSort_simd
+enum simd_isa_enum {
+	SIMD_AUTO = -1,
+	SIMD_SCALAR = 0,
+	SIMD_AVX2,
+	SIMD_AVX512
+};
+
+/**
+	\brief Melhor conjunto de instruções suportado pela CPU em que o programa roda
+*/
+int best_simd_isa(void);
+
+/**
+	\brief BubbleSort_persistent com as fases vetorizadas
+
+	Cada registrador guarda 2 (AVX2) ou 4 (AVX-512) pares vizinhos; o
+	mínimo e o máximo de cada par são escritos de volta sem desvio e a
+	máscara da comparação diz se houve alguma troca. O resultado é o mesmo
+	de BubbleSort_serial.
+
+	\param isa um valor de simd_isa_enum; SIMD_AUTO escolhe best_simd_isa()
+
+	\return o conjunto de instruções usado
+*/
+int BubbleSort_simd(double *array, long int size, int isa, odd_even_statistics_t *statistics);
+
+/**
+	\brief Transposição par-ímpar em blocos (merge-split)
+
+	Cada uma das P threads ordena localmente um trecho contíguo do vetor e,
+	em P rodadas alternando pares pares/ímpares de trechos vizinhos, os dois
+	trechos de cada par são fundidos: a thread da esquerda fica com os
+	menores elementos e a da direita com os maiores. Custa
+	O((N/P) log(N/P) + N) em vez de O(N²), numa única região paralela.
+*/
+void BubbleSort_block(double *array, long int size);
+
+/**
+	\brief Ordenação bitônica: rede de ordenação de profundidade O(log² N)
+
+	Como a transposição par-ímpar, é uma rede fixa de comparações que não
+	depende dos dados, mas com log N (log N + 1) / 2 estágios em vez de N
+	rodadas. Tamanhos que não são potência de 2 são completados com +inf.
+	Cada estágio é dividido entre as threads em faixas fixas, com uma
+	barreira entre estágios; as comparações dentro de um registrador
+	(distância menor que a largura do vetor) usam permutações e máscaras.
+
+	\param isa um valor de simd_isa_enum; SIMD_AUTO escolhe best_simd_isa()
+
+	\return o conjunto de instruções usado
+*/
+int BubbleSort_bitonic(double *array, long int size, int isa);
+
+/**
+	\brief Shearsort: ordena uma matriz linhas x colunas em ordem serpentina
+
+	Alterna fases em que todas as linhas são ordenadas (pares em ordem
+	crescente, ímpares em ordem decrescente) com fases em que todas as
+	colunas são ordenadas de cima para baixo; após ceil(log2 L) pares de
+	fases e uma última fase de linhas, a matriz lida em serpentina (linha 0
+	da esquerda para a direita, linha 1 da direita para a esquerda, ...)
+	está ordenada. Cada fase divide as linhas, ou blocos de colunas
+	vizinhas, entre as threads de uma única região paralela.
+
+	\param matrix matriz em ordem de linhas, acessada com M(i, j, columns, matrix)
+
+	\return o número de fases executadas
+*/
+long int ShearSort_parallel(double *matrix, long int lines, long int columns);
+
+/**
+	\brief Copia a matriz para vector em ordem serpentina
+*/
+void snake_to_vector(const double *matrix, long int lines, long int columns, double *vector);
+
+#endif
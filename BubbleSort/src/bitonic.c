@@ -0,0 +1,158 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <immintrin.h>
+#include <libppc.h>
+#include <omp.h>
+
+#include "bubblesort.h"
+
+// Mesmos atributos de oddeven.c: seleção do conjunto de instruções em
+// tempo de execução e kernels otimizados mesmo no build -O0
+#define AVX2 __attribute__((target("avx2"), optimize("O2")))
+#define AVX512 __attribute__((target("avx512f"), optimize("O2")))
+
+// Menor rede montada; também é o tamanho, em pares, das faixas dadas a cada
+// thread, para que nenhum registrador de 8 doubles fique entre duas threads
+#define BITONIC_CHUNK 8
+#define BITONIC_MIN_SIZE (2 * BITONIC_CHUNK)
+
+// Um estágio (k, j) da rede sobre os pares de índice q0 até q1 - 1. O par q
+// compara a[i] e a[i + j], com i = (q / j) * 2j + q % j, e deixa o menor
+// em a[i] se (i & k) == 0 e o maior caso contrário.
+typedef void (*stage_kernel_t)(double *a, long int q0, long int q1, long int j, long int k);
+
+
+static void stage_scalar(double *a, long int q0, long int q1, long int j, long int k) {
+    for (long int q = q0; q < q1; q++) {
+        long int i = (q / j) * 2 * j + q % j;
+        int ascending = (i & k) == 0;
+        if (ascending ? a[i] > a[i + j] : a[i] < a[i + j]) {
+            double temp = a[i];
+            a[i] = a[i + j];
+            a[i + j] = temp;
+        }
+    }
+}
+
+
+// Com j >= 4 os 4 pares consecutivos têm as duas metades contíguas e a
+// mesma direção: um min e um max entre dois registradores. Com j < 4 os
+// dois elementos do par estão no mesmo registrador; o vizinho vem de uma
+// permutação e uma máscara por lane escolhe o mínimo ou o máximo.
+static AVX2 void stage_avx2(double *a, long int q0, long int q1, long int j, long int k) {
+    if (j >= 4) {
+        for (long int q = q0; q < q1; q += 4) {
+            long int i = (q / j) * 2 * j + q % j;
+            __m256d x = _mm256_loadu_pd(&a[i]);
+            __m256d y = _mm256_loadu_pd(&a[i + j]);
+            __m256d low = _mm256_min_pd(x, y), high = _mm256_max_pd(x, y);
+            _mm256_storeu_pd(&a[i], (i & k) ? high : low);
+            _mm256_storeu_pd(&a[i + j], (i & k) ? low : high);
+        }
+        return;
+    }
+
+    // Lanes que recebem o máximo: as de cima do par numa sequência
+    // crescente, as de baixo numa decrescente. Com k < 4 a direção muda
+    // dentro do registrador (lane & k); com k >= 4 ela vem do índice.
+    __m256d take_max[2];
+    for (int descending = 0; descending < 2; descending++) {
+        double lanes[4];
+        for (int lane = 0; lane < 4; lane++) {
+            int upper = (lane & j) != 0;
+            int flip = descending || (lane & k) != 0;
+            lanes[lane] = (upper != flip) ? -1.0 : 0.0;
+        }
+        take_max[descending] = _mm256_loadu_pd(lanes);
+    }
+
+    for (long int i = 2 * q0; i < 2 * q1; i += 4) {
+        __m256d v = _mm256_loadu_pd(&a[i]);
+        __m256d t = (j == 1) ? _mm256_permute_pd(v, 0x5) : _mm256_permute4x64_pd(v, 0x4E);
+        __m256d mask = take_max[(i & k) != 0];
+        _mm256_storeu_pd(&a[i], _mm256_blendv_pd(_mm256_min_pd(v, t), _mm256_max_pd(v, t), mask));
+    }
+}
+
+
+// 8 pares por registrador, mesma ideia; o vizinho com j < 8 vem de uma
+// permutação lane ^ j e a máscara é um __mmask8
+static AVX512 void stage_avx512(double *a, long int q0, long int q1, long int j, long int k) {
+    if (j >= 8) {
+        for (long int q = q0; q < q1; q += 8) {
+            long int i = (q / j) * 2 * j + q % j;
+            __m512d x = _mm512_loadu_pd(&a[i]);
+            __m512d y = _mm512_loadu_pd(&a[i + j]);
+            __m512d low = _mm512_min_pd(x, y), high = _mm512_max_pd(x, y);
+            _mm512_storeu_pd(&a[i], (i & k) ? high : low);
+            _mm512_storeu_pd(&a[i + j], (i & k) ? low : high);
+        }
+        return;
+    }
+
+    __m512i partner = _mm512_set_epi64(7 ^ j, 6 ^ j, 5 ^ j, 4 ^ j, 3 ^ j, 2 ^ j, 1 ^ j, 0 ^ j);
+    __mmask8 take_max[2] = { 0, 0 };
+    for (int descending = 0; descending < 2; descending++) {
+        for (int lane = 0; lane < 8; lane++) {
+            int upper = (lane & j) != 0;
+            int flip = descending || (lane & k) != 0;
+            if (upper != flip)
+                take_max[descending] |= 1 << lane;
+        }
+    }
+
+    for (long int i = 2 * q0; i < 2 * q1; i += 8) {
+        __m512d v = _mm512_loadu_pd(&a[i]);
+        __m512d t = _mm512_permutexvar_pd(partner, v);
+        __mmask8 mask = take_max[(i & k) != 0];
+        _mm512_storeu_pd(&a[i], _mm512_mask_blend_pd(mask, _mm512_min_pd(v, t), _mm512_max_pd(v, t)));
+    }
+}
+
+
+int BubbleSort_bitonic(double *array, long int size, int isa) {
+    if (isa == SIMD_AUTO)
+        isa = best_simd_isa();
+    stage_kernel_t stage = stage_scalar;
+    if (isa == SIMD_AVX512)
+        stage = stage_avx512;
+    else if (isa == SIMD_AVX2)
+        stage = stage_avx2;
+    if (size < 2)
+        return isa;
+
+    // A rede só existe para potências de 2: o vetor é copiado para um
+    // buffer completado com +inf, que termina no final e é descartado
+    long int n = BITONIC_MIN_SIZE;
+    while (n < size)
+        n *= 2;
+    double *buffer = (double*)allocate_aligned_memory(sizeof(double) * n);
+    memcpy(buffer, array, sizeof(double) * size);
+    for (long int i = size; i < n; i++)
+        buffer[i] = INFINITY;
+
+    // Uma região paralela para a rede inteira. Cada estágio tem n / 2
+    // comparações independentes, divididas em faixas fixas; a única
+    // sincronização é a barreira entre estágios, log n (log n + 1) / 2 ao todo.
+    #pragma omp parallel
+    {
+        int t = omp_get_thread_num();
+        int threads = omp_get_num_threads();
+        long int chunks = n / 2 / BITONIC_CHUNK;
+        long int q0 = chunks * t / threads * BITONIC_CHUNK;
+        long int q1 = chunks * (t + 1) / threads * BITONIC_CHUNK;
+
+        for (long int k = 2; k <= n; k *= 2) {
+            for (long int j = k / 2; j > 0; j /= 2) {
+                stage(buffer, q0, q1, j, k);
+                #pragma omp barrier
+            }
+        }
+    }
+
+    memcpy(array, buffer, sizeof(double) * size);
+    free_aligned_memory(buffer);
+    return isa;
+}
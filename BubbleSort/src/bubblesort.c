@@ -7,17 +7,65 @@
 #include <string.h>
 #include <stdbool.h>
 
+#include "bubblesort.h"
+
 // Defina aqui o tamanho do vetor
 #define SIZE 10000
 
 // Descomente para debug
 //#define __DEBUG__
 
+// Compile com make clean all CFLAGS=-D__TRACE__ para gravar as trocas do
+// fluxo padrão em trace.dat; LibPPC/examples/tracedump mostra o trace
+#define TRACE_THREADS 8
+#define TRACE_EVENTS_PER_THREAD (1L << 20)
+
 enum implementations_enum {
     TYPE_SERIAL = 1,
-    TYPE_PARALLEL
+    TYPE_PARALLEL,
+    TYPE_BLOCK,
+    TYPE_PERSISTENT,
+    TYPE_SIMD,
+    TYPE_ADAPTIVE,
+    TYPE_BITONIC,
+    TYPE_SHEAR
+};
+
+// Nomes aceitos pela opção -m, indexados por implementations_enum
+static const char *implementation_names[] = {
+    [TYPE_PARALLEL] = "parallel",
+    [TYPE_BLOCK] = "block",
+    [TYPE_PERSISTENT] = "persistent",
+    [TYPE_SIMD] = "simd",
+    [TYPE_ADAPTIVE] = "adaptive",
+    [TYPE_BITONIC] = "bitonic",
+    [TYPE_SHEAR] = "shear"
+};
+
+// Distribuições do vetor de entrada (opção -d)
+enum distributions_enum {
+    DIST_RANDOM = 0,
+    DIST_NEARLY_SORTED
+};
+
+static const char *distribution_names[] = {
+    [DIST_RANDOM] = "random",
+    [DIST_NEARLY_SORTED] = "nearly"
+};
+
+static int distribution = DIST_RANDOM;
+
+// Nomes aceitos pela opção -i, indexados por simd_isa_enum
+static const char *isa_names[] = {
+    [SIMD_SCALAR] = "scalar",
+    [SIMD_AVX2] = "avx2",
+    [SIMD_AVX512] = "avx512"
 };
 
+static int simd_isa = SIMD_AUTO;
+
+typedef void (*sort_function_t)(double *array, long int size);
+
 void BubbleSort_serial(double *array, long int size) {
     int swapped;
     long int n = size;
@@ -35,6 +83,7 @@ void BubbleSort_serial(double *array, long int size) {
                 double temp = array[i];
                 array[i] = array[i + 1];
                 array[i + 1] = temp;
+                TRACE_SWAP(i, i + 1);
 
                 swapped = 1;
             }
@@ -61,6 +110,7 @@ void BubbleSort_parallel(double *array, long int size) {
                 double temp = array[i];
                 array[i] = array[i + 1];
                 array[i + 1] = temp;
+                TRACE_SWAP(i, i + 1);
                 swapped = true;
             }
         }
@@ -73,6 +123,7 @@ void BubbleSort_parallel(double *array, long int size) {
                 double temp = array[i];
                 array[i] = array[i + 1];
                 array[i + 1] = temp;
+                TRACE_SWAP(i, i + 1);
                 swapped = true;
             }
         }
@@ -85,46 +136,379 @@ void BubbleSort_parallel(double *array, long int size) {
 
 
 
+int parse_implementation(const char *name) {
+    int count = sizeof(implementation_names) / sizeof(implementation_names[0]);
+    for (int i = 0; i < count; i++) {
+        if (implementation_names[i] != NULL && strcmp(implementation_names[i], name) == 0)
+            return i;
+    }
+    return -1;
+}
+
+
+static int compare_doubles(const void *a, const void *b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+
+// Gera um vetor com a distribuição escolhida em -d
+double *generate_vector(long int size) {
+    double *vector = generate_random_double_vector(size, 0.0, 1000.0);
+    if (distribution == DIST_NEARLY_SORTED) {
+        // 1% dos elementos trocados com um vizinho próximo
+        qsort(vector, size, sizeof(double), compare_doubles);
+        for (long int s = 0; s < size / 100; s++) {
+            long int i = rand() % size, j = i + rand() % 64;
+            if (j < size) {
+                double t = vector[i];
+                vector[i] = vector[j];
+                vector[j] = t;
+            }
+        }
+    }
+    return vector;
+}
+
+
+// Carrega o vetor da distribuição escolhida (vector.dat para a aleatória,
+// vector_<distribuição>.dat para as outras) ou gera um novo se o arquivo
+// não existe ou tem menos que size elementos
+double *load_or_generate_vector(long int size) {
+    char filename[64] = "vector.dat";
+    if (distribution != DIST_RANDOM)
+        snprintf(filename, sizeof(filename), "vector_%s.dat", distribution_names[distribution]);
+
+    double *vector = NULL;
+    if (access(filename, F_OK) == 0) {
+        printf("\nLoading vector from file...");
+        vector = load_double_vector(filename, size);
+    }
+    if (vector == NULL) {
+        printf("\nGenerating new vector (%s)...", distribution_names[distribution]);
+        vector = generate_vector(size);
+        save_double_vector(vector, size, filename);
+    }
+    return vector;
+}
+
+
+// Imprime o modo de páginas grandes escolhido em -p
+void print_huge_page_mode(void) {
+    int mode = get_huge_page_mode();
+    printf("\nHuge page mode: %s", mode == HUGE_PAGES_EXPLICIT ? "explicit" :
+        (mode == HUGE_PAGES_TRANSPARENT ? "thp" : "none"));
+}
+
+
+// Imprime as falhas de dTLB medidas durante a ordenação
+void print_dtlb_misses(long long misses) {
+    if (misses < 0) {
+        printf("\ndTLB misses: not available");
+    } else {
+        printf("\ndTLB misses: %lld", misses);
+    }
+}
+
+
+// Roda uma variante com 1, 2 e 4 threads e compara cada saída com BubbleSort_serial
+int run_variant(const char *name, sort_function_t sort, long int size) {
+    double *vector = load_or_generate_vector(size);
+    double *vector_serial = (double*)malloc(sizeof(double) * size);
+    memcpy(vector_serial, vector, sizeof(double) * size);
+
+    print_huge_page_mode();
+    printf("\nRunning serial Bubblesort...");
+    double start = omp_get_wtime();
+    BubbleSort_serial(vector_serial, size);
+    double time_serial = omp_get_wtime() - start;
+    printf("\nSerial time: %.6f seconds\n", time_serial);
+    save_double_vector(vector_serial, size, "sorted_serial.dat");
+
+    int errors = 0;
+    double *vector_parallel = allocate_double_vector_first_touch(size);
+    for (int threads = 1; threads <= 4; threads *= 2) {
+        printf("\n----------------------------------------------\n");
+        omp_set_num_threads(threads);
+        memcpy(vector_parallel, vector, sizeof(double) * size);
+        printf("\nRunning %s Bubblesort (%d threads)...", name, threads);
+        start_dtlb_miss_counters();
+        start = omp_get_wtime();
+        sort(vector_parallel, size);
+        double time_parallel = omp_get_wtime() - start;
+        long long tlb_misses = stop_dtlb_miss_counters();
+        printf("\nParallel time (%d threads): %.6f seconds", threads, time_parallel);
+        print_dtlb_misses(tlb_misses);
+        printf("\n");
+
+        char filename[64];
+        snprintf(filename, sizeof(filename), "sorted_%s_%d.dat", name, threads);
+        save_double_vector(vector_parallel, size, filename);
+        double speedup = time_serial / time_parallel;
+        printf("\nSpeedup (%d threads): %.3f", threads, speedup);
+        printf("\nEficiência (%d threads): %.3f", threads, speedup / threads);
+        if (compare_double_vector_on_files("sorted_serial.dat", filename)) {
+            printf("\nOK! Serial and %s (%d threads) outputs are equal!", name, threads);
+        } else {
+            printf("\nERROR! Outputs are NOT equal for %s with %d threads!", name, threads);
+            errors++;
+        }
+    }
+
+    free_aligned_memory(vector);
+    free(vector_serial);
+    free_aligned_memory(vector_parallel);
+    printf("\n");
+    return errors > 0;
+}
+
+
+void print_odd_even_statistics(const odd_even_statistics_t *statistics) {
+    double total = statistics->work_time + statistics->sync_time;
+    printf("\nRounds: %ld | parallel regions: 1 (BubbleSort_parallel opens %ld)",
+        statistics->rounds, 2 * statistics->rounds);
+    printf("\nPer thread: work %.6f seconds | synchronization %.6f seconds (%.1f%%)",
+        statistics->work_time, statistics->sync_time,
+        total > 0 ? 100.0 * statistics->sync_time / total : 0.0);
+    if (statistics->active_fraction < 1.0)
+        printf("\nMean active window: %.1f%% of the vector", 100.0 * statistics->active_fraction);
+}
+
+
+void sort_persistent(double *array, long int size) {
+    odd_even_statistics_t statistics;
+    BubbleSort_persistent(array, size, &statistics);
+    print_odd_even_statistics(&statistics);
+}
+
+
+void sort_simd(double *array, long int size) {
+    odd_even_statistics_t statistics;
+    int isa = BubbleSort_simd(array, size, simd_isa, &statistics);
+    printf("\nInstruction set: %s", isa_names[isa]);
+    print_odd_even_statistics(&statistics);
+}
+
+
+void sort_adaptive(double *array, long int size) {
+    odd_even_statistics_t statistics;
+    BubbleSort_adaptive(array, size, &statistics);
+    print_odd_even_statistics(&statistics);
+}
+
+
+void sort_bitonic(double *array, long int size) {
+    int isa = BubbleSort_bitonic(array, size, simd_isa);
+    long int n = 1, stages = 0;
+    for (int levels = 1; n < size; levels++) {
+        n *= 2;
+        stages += levels;
+    }
+    printf("\nInstruction set: %s", isa_names[isa]);
+    printf("\nNetwork: %ld stages (odd-even transposition: %ld rounds)", stages, size);
+}
+
+
+// Shearsort numa matriz lines x columns carregada de matrix_<L>x<C>.dat com
+// load_double_matrix; a matriz lida em serpentina é comparada com a saída
+// de BubbleSort_serial sobre os mesmos valores
+int run_shear(long int lines, long int columns) {
+    long int size = lines * columns;
+    char matrix_file[64];
+    snprintf(matrix_file, sizeof(matrix_file), "matrix_%ldx%ld.dat", lines, columns);
+    double *matrix = NULL;
+    if (access(matrix_file, F_OK) == 0) {
+        printf("\nLoading %ld x %ld matrix from file...", lines, columns);
+        matrix = load_double_matrix(matrix_file, lines, columns);
+    }
+    if (matrix == NULL) {
+        printf("\nGenerating new %ld x %ld matrix...", lines, columns);
+        matrix = generate_random_double_matrix(lines, columns);
+        save_double_matrix(matrix, lines, columns, matrix_file);
+    }
+
+    double *vector_serial = (double*)malloc(sizeof(double) * size);
+    memcpy(vector_serial, matrix, sizeof(double) * size);
+    printf("\nRunning serial Bubblesort...");
+    double start = omp_get_wtime();
+    BubbleSort_serial(vector_serial, size);
+    double time_serial = omp_get_wtime() - start;
+    printf("\nSerial time: %.6f seconds\n", time_serial);
+    save_double_vector(vector_serial, size, "sorted_serial.dat");
+
+    int errors = 0;
+    double *sorted = (double*)allocate_aligned_memory(sizeof(double) * size);
+    double *snake = (double*)malloc(sizeof(double) * size);
+    for (int threads = 1; threads <= 4; threads *= 2) {
+        printf("\n----------------------------------------------\n");
+        omp_set_num_threads(threads);
+        memcpy(sorted, matrix, sizeof(double) * size);
+        printf("\nRunning shearsort (%d threads)...", threads);
+        start = omp_get_wtime();
+        long int phases = ShearSort_parallel(sorted, lines, columns);
+        double time_parallel = omp_get_wtime() - start;
+        printf("\nPhases: %ld (row and column sorts)", phases);
+        printf("\nParallel time (%d threads): %.6f seconds\n", threads, time_parallel);
+
+        char filename[64];
+        snprintf(filename, sizeof(filename), "sorted_shear_%d.dat", threads);
+        snake_to_vector(sorted, lines, columns, snake);
+        save_double_vector(snake, size, filename);
+        double speedup = time_serial / time_parallel;
+        printf("\nSpeedup (%d threads): %.3f", threads, speedup);
+        printf("\nEficiência (%d threads): %.3f", threads, speedup / threads);
+        if (compare_double_vector_on_files("sorted_serial.dat", filename)) {
+            printf("\nOK! Serial and shearsort (%d threads) outputs are equal!", threads);
+        } else {
+            printf("\nERROR! Outputs are NOT equal for shearsort with %d threads!", threads);
+            errors++;
+        }
+    }
+
+    free_aligned_memory(matrix);
+    free_aligned_memory(sorted);
+    free(vector_serial);
+    free(snake);
+    printf("\n");
+    return errors > 0;
+}
+
+
 int main(int argc, char **argv) {
     srand(time(NULL));
+    int implementation = TYPE_PARALLEL;
+    long int size = SIZE, lines = 0;
+    int huge_page_mode = HUGE_PAGES_NONE;
+    int opt;
+    while ((opt = getopt(argc, argv, "d:i:l:m:n:p:")) != -1) {
+        switch (opt) {
+        case 'd':
+            for (distribution = DIST_NEARLY_SORTED; distribution >= DIST_RANDOM; distribution--) {
+                if (strcmp(distribution_names[distribution], optarg) == 0)
+                    break;
+            }
+            if (distribution < DIST_RANDOM) {
+                fprintf(stderr, "Unknown distribution: %s\n", optarg);
+                return 1;
+            }
+            break;
+        case 'i':
+            if (strcmp(optarg, "auto") == 0) {
+                simd_isa = SIMD_AUTO;
+                break;
+            }
+            for (simd_isa = SIMD_AVX512; simd_isa >= SIMD_SCALAR; simd_isa--) {
+                if (strcmp(isa_names[simd_isa], optarg) == 0)
+                    break;
+            }
+            if (simd_isa < SIMD_SCALAR) {
+                fprintf(stderr, "Unknown instruction set: %s\n", optarg);
+                return 1;
+            }
+            if (simd_isa > best_simd_isa()) {
+                fprintf(stderr, "Instruction set not supported by this CPU: %s\n", optarg);
+                return 1;
+            }
+            break;
+        case 'l':
+            lines = atol(optarg);
+            break;
+        case 'm':
+            implementation = parse_implementation(optarg);
+            if (implementation < 0) {
+                fprintf(stderr, "Unknown implementation: %s\n", optarg);
+                return 1;
+            }
+            break;
+        case 'n':
+            size = atol(optarg);
+            break;
+        case 'p':
+            huge_page_mode = parse_huge_page_mode(optarg);
+            if (huge_page_mode < 0) {
+                fprintf(stderr, "Unknown huge page mode: %s\n", optarg);
+                return 1;
+            }
+            break;
+        default:
+            fprintf(stderr, "Usage: %s [-m parallel|block|persistent|simd|adaptive|bitonic|shear] [-n size]\n"
+                "          [-d random|nearly] [-i auto|scalar|avx2|avx512] [-l matrix lines]\n"
+                "          [-p none|thp|explicit]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    // Vale para todos os vetores alocados pela LibPPC daqui em diante
+    set_huge_page_mode(huge_page_mode);
+
+    if (implementation == TYPE_BLOCK)
+        return run_variant("block", BubbleSort_block, size);
+    if (implementation == TYPE_PERSISTENT)
+        return run_variant("persistent", sort_persistent, size);
+    if (implementation == TYPE_SIMD)
+        return run_variant("simd", sort_simd, size);
+    if (implementation == TYPE_ADAPTIVE)
+        return run_variant("adaptive", sort_adaptive, size);
+    if (implementation == TYPE_BITONIC)
+        return run_variant("bitonic", sort_bitonic, size);
+    if (implementation == TYPE_SHEAR) {
+        // Sem -l, a matriz mais próxima de quadrada com no máximo size elementos
+        if (lines <= 0)
+            while ((lines + 1) * (lines + 1) <= size)
+                lines++;
+        if (lines <= 0 || size / lines <= 0) {
+            fprintf(stderr, "Invalid matrix shape: %ld elements in %ld lines\n", size, lines);
+            return 1;
+        }
+        return run_shear(lines, size / lines);
+    }
 
     // Sempre gere ou carregue o vetor original
     double *vector_serial, *vector_2, *vector_4;
-    if (access("vector.dat", F_OK) != 0) {
-        printf("\nGenerating new vector...");
-        vector_serial = generate_random_double_vector(SIZE, 0.0, 1000.0);
-        save_double_vector(vector_serial, SIZE, "vector.dat");
-    } else {
-        printf("\nLoading vector from file...");
-        vector_serial = load_double_vector("vector.dat", SIZE);
-    }
-    // Cópias para execuções paralelas
-    vector_2 = (double*)malloc(sizeof(double) * SIZE);
-    vector_4 = (double*)malloc(sizeof(double) * SIZE);
-    memcpy(vector_2, vector_serial, sizeof(double) * SIZE);
-    memcpy(vector_4, vector_serial, sizeof(double) * SIZE);
+    vector_serial = load_or_generate_vector(size);
+    // Cópias para execuções paralelas, feitas pelas threads que vão usá-las
+    omp_set_num_threads(2);
+    vector_2 = copy_double_vector_first_touch(vector_serial, size);
+    omp_set_num_threads(4);
+    vector_4 = copy_double_vector_first_touch(vector_serial, size);
+
+#ifdef __TRACE__
+    trace_start(TRACE_THREADS, TRACE_EVENTS_PER_THREAD);
+#endif
 
     // Serial
     double start, end, time_serial = 0, time_parallel_2 = 0, time_parallel_4 = 0;
+    long long tlb_misses;
+    print_huge_page_mode();
     printf("\nRunning serial Bubblesort...");
+    TRACE_BEGIN(1);
+    start_dtlb_miss_counters();
     start = omp_get_wtime();
-    BubbleSort_serial(vector_serial, SIZE);
+    BubbleSort_serial(vector_serial, size);
     end = omp_get_wtime();
+    tlb_misses = stop_dtlb_miss_counters();
     time_serial = end - start;
-    printf("\nSerial time: %.6f seconds\n", time_serial);
-    save_double_vector(vector_serial, SIZE, "sorted_serial.dat");
+    printf("\nSerial time: %.6f seconds", time_serial);
+    print_dtlb_misses(tlb_misses);
+    printf("\n");
+    save_double_vector(vector_serial, size, "sorted_serial.dat");
 
      printf("\n----------------------------------------------\n");
 
     // Paralelo 2 threads
     omp_set_num_threads(2);
     printf("\nRunning parallel Bubblesort (2 threads)...");
+    TRACE_BEGIN(2);
+    start_dtlb_miss_counters();
     start = omp_get_wtime();
-    BubbleSort_parallel(vector_2, SIZE);
+    BubbleSort_parallel(vector_2, size);
     end = omp_get_wtime();
+    tlb_misses = stop_dtlb_miss_counters();
     time_parallel_2 = end - start;
-    printf("\nParallel time (2 threads): %.6f seconds\n", time_parallel_2);
-    save_double_vector(vector_2, SIZE, "sorted_parallel_2.dat");
+    printf("\nParallel time (2 threads): %.6f seconds", time_parallel_2);
+    print_dtlb_misses(tlb_misses);
+    printf("\n");
+    save_double_vector(vector_2, size, "sorted_parallel_2.dat");
     double speedup_2 = time_serial / time_parallel_2;
     double eficiencia_2 = speedup_2 / 2.0;
     printf("\nSpeedup (2 threads): %.3f", speedup_2);
@@ -135,12 +519,17 @@ int main(int argc, char **argv) {
     // Paralelo 4 threads
     omp_set_num_threads(4);
     printf("\nRunning parallel Bubblesort (4 threads)...");
+    TRACE_BEGIN(4);
+    start_dtlb_miss_counters();
     start = omp_get_wtime();
-    BubbleSort_parallel(vector_4, SIZE);
+    BubbleSort_parallel(vector_4, size);
     end = omp_get_wtime();
+    tlb_misses = stop_dtlb_miss_counters();
     time_parallel_4 = end - start;
-    printf("\nParallel time (4 threads): %.6f seconds\n", time_parallel_4);
-    save_double_vector(vector_4, SIZE, "sorted_parallel_4.dat");
+    printf("\nParallel time (4 threads): %.6f seconds", time_parallel_4);
+    print_dtlb_misses(tlb_misses);
+    printf("\n");
+    save_double_vector(vector_4, size, "sorted_parallel_4.dat");
     double speedup_4 = time_serial / time_parallel_4;
     double eficiencia_4 = speedup_4 / 4.0;
     printf("\nSpeedup (4 threads): %.3f", speedup_4);
@@ -167,9 +556,14 @@ int main(int argc, char **argv) {
         printf("\nERROR! Outputs are NOT equal for 4 threads!");
     }
 
-    free(vector_serial);
-    free(vector_2);
-    free(vector_4);
+#ifdef __TRACE__
+    printf("\nTrace: %ld events saved on trace.dat", trace_save("trace.dat"));
+    trace_stop();
+#endif
+
+    free_aligned_memory(vector_serial);
+    free_aligned_memory(vector_2);
+    free_aligned_memory(vector_4);
     printf("\n");
     return 0;
 }
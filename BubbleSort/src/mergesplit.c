@@ -0,0 +1,88 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <libppc.h>
+#include <omp.h>
+
+#include "bubblesort.h"
+
+
+static int compare_doubles(const void *a, const void *b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+
+// Os length menores elementos da fusão de a[0..na) e b[0..nb), em output
+static void merge_low(const double *a, long int na, const double *b, long int nb,
+                      double *output, long int length) {
+    long int i = 0, j = 0;
+    for (long int k = 0; k < length; k++) {
+        if (j >= nb || (i < na && a[i] <= b[j]))
+            output[k] = a[i++];
+        else
+            output[k] = b[j++];
+    }
+}
+
+
+// Os length maiores elementos da fusão, preenchendo output de trás para frente
+static void merge_high(const double *a, long int na, const double *b, long int nb,
+                       double *output, long int length) {
+    long int i = na - 1, j = nb - 1;
+    for (long int k = length - 1; k >= 0; k--) {
+        if (i < 0 || (j >= 0 && b[j] >= a[i]))
+            output[k] = b[j--];
+        else
+            output[k] = a[i--];
+    }
+}
+
+
+void BubbleSort_block(double *array, long int size) {
+    int threads = omp_get_max_threads();
+    if (threads > size)
+        threads = size > 0 ? (int)size : 1;
+    double *buffer = (double*)allocate_aligned_memory(sizeof(double) * (size > 0 ? size : 1));
+
+    #pragma omp parallel num_threads(threads)
+    {
+        int t = omp_get_thread_num();
+        int team = omp_get_num_threads();
+        long int first = size * t / team, last = size * (t + 1) / team;
+
+        // Ordenação local do trecho: O((N/P) log(N/P))
+        qsort(&array[first], last - first, sizeof(double), compare_doubles);
+
+        // P rodadas de merge-split: na rodada r, o trecho t faz par com o
+        // vizinho da direita se t e r têm a mesma paridade, senão com o da
+        // esquerda. As duas threads do par fundem os mesmos dois trechos,
+        // uma pela frente e outra por trás, sem escrever no trecho da outra.
+        for (int round = 0; round < team; round++) {
+            #pragma omp barrier
+            int partner = ((t - round) % 2 == 0) ? t + 1 : t - 1;
+            int exchanged = 0;
+            if (partner >= 0 && partner < team) {
+                long int partner_first = size * partner / team, partner_last = size * (partner + 1) / team;
+                // Trechos já em ordem entre si não precisam ser fundidos
+                if (partner > t && last > first && partner_last > partner_first &&
+                    array[last - 1] > array[partner_first]) {
+                    merge_low(&array[first], last - first, &array[partner_first], partner_last - partner_first,
+                              &buffer[first], last - first);
+                    exchanged = 1;
+                } else if (partner < t && last > first && partner_last > partner_first &&
+                           array[partner_last - 1] > array[first]) {
+                    merge_high(&array[partner_first], partner_last - partner_first, &array[first], last - first,
+                               &buffer[first], last - first);
+                    exchanged = 1;
+                }
+            }
+            // Ninguém sobrescreve o próprio trecho antes do vizinho terminar de lê-lo
+            #pragma omp barrier
+            if (exchanged)
+                memcpy(&array[first], &buffer[first], sizeof(double) * (last - first));
+        }
+    }
+
+    free_aligned_memory(buffer);
+}
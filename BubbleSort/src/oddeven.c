@@ -0,0 +1,294 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <immintrin.h>
+#include <libppc.h>
+#include <omp.h>
+
+#include "bubblesort.h"
+
+// As funções SIMD são compiladas para o seu conjunto de instruções com o
+// atributo target e escolhidas em tempo de execução, então o Makefile não
+// precisa de -mavx2/-mavx512f e o binário roda em qualquer x86-64. Elas
+// também são otimizadas mesmo no build -O0: sem isso cada resultado de
+// intrínseca vai para a pilha e volta, e o kernel fica mais lento que o escalar.
+#define AVX2 __attribute__((target("avx2"), optimize("O2")))
+#define AVX512 __attribute__((target("avx512f"), optimize("O2")))
+
+// Elementos por bloco de BubbleSort_adaptive (par, para que a fase par de
+// cada bloco comece no primeiro elemento dele)
+#define ADAPTIVE_CHUNK 64
+
+// Compara e troca os pares (a[0], a[1]), (a[2], a[3]), ... de uma fase;
+// retorna 1 se alguma troca aconteceu
+typedef int (*phase_kernel_t)(double *a, long int pairs);
+
+
+int best_simd_isa(void) {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+        return SIMD_AVX512;
+    if (__builtin_cpu_supports("avx2"))
+        return SIMD_AVX2;
+    return SIMD_SCALAR;
+}
+
+
+static int phase_scalar(double *a, long int pairs) {
+    int swapped = 0;
+    for (long int p = 0; p < pairs; p++) {
+        if (a[2 * p] > a[2 * p + 1]) {
+            double temp = a[2 * p];
+            a[2 * p] = a[2 * p + 1];
+            a[2 * p + 1] = temp;
+            swapped = 1;
+        }
+    }
+    return swapped;
+}
+
+
+// 2 pares por registrador: o vizinho de cada lane vem de uma permutação
+// dentro das metades de 128 bits; as lanes pares recebem o mínimo e as
+// ímpares o máximo, sem desvio. A máscara da comparação diz se houve troca.
+static AVX2 int phase_avx2(double *a, long int pairs) {
+    int mask = 0;
+    long int p = 0;
+    for (; p + 2 <= pairs; p += 2) {
+        __m256d v = _mm256_loadu_pd(&a[2 * p]);
+        __m256d t = _mm256_permute_pd(v, 0x5);
+        mask |= _mm256_movemask_pd(_mm256_cmp_pd(v, t, _CMP_GT_OQ));
+        _mm256_storeu_pd(&a[2 * p], _mm256_blend_pd(_mm256_min_pd(v, t), _mm256_max_pd(v, t), 0xA));
+    }
+    int swapped = phase_scalar(&a[2 * p], pairs - p);
+    return swapped || (mask & 0x5) != 0;
+}
+
+
+// 4 pares por registrador, mesma ideia com máscaras de 8 bits
+static AVX512 int phase_avx512(double *a, long int pairs) {
+    __mmask8 mask = 0;
+    long int p = 0;
+    for (; p + 4 <= pairs; p += 4) {
+        __m512d v = _mm512_loadu_pd(&a[2 * p]);
+        __m512d t = _mm512_permute_pd(v, 0x55);
+        mask |= _mm512_cmp_pd_mask(v, t, _CMP_GT_OQ);
+        _mm512_storeu_pd(&a[2 * p], _mm512_mask_blend_pd(0xAA, _mm512_min_pd(v, t), _mm512_max_pd(v, t)));
+    }
+    int swapped = phase_scalar(&a[2 * p], pairs - p);
+    return swapped || (mask & 0x55) != 0;
+}
+
+
+// Transposição par-ímpar numa única região paralela. Cada thread fica com
+// uma faixa fixa de pares em cada fase e chama o kernel da fase sobre ela.
+static void odd_even_sort(double *array, long int size, phase_kernel_t phase,
+                          odd_even_statistics_t *statistics) {
+    // Flag de convergência em três posições alternadas: na rodada r as
+    // threads marcam changed[r % 3] e, depois da barreira, todas a leem;
+    // changed[(r + 1) % 3] é zerada durante a rodada r, quando ninguém mais
+    // lê nem escreve nela, sem uma barreira extra só para zerar a flag.
+    int changed[3] = { 0, 0, 0 };
+    double total_work = 0, total_sync = 0;
+    long int rounds = 0;
+    int team = 1;
+
+    #pragma omp parallel shared(changed)
+    {
+        int t = omp_get_thread_num();
+        int threads = omp_get_num_threads();
+        // Pares (i, i + 1) da fase par (i = 0, 2, ...) e da ímpar (i = 1, 3, ...)
+        long int even_pairs = size / 2, odd_pairs = (size - 1) / 2;
+        long int even_first = even_pairs * t / threads, even_last = even_pairs * (t + 1) / threads;
+        long int odd_first = odd_pairs * t / threads, odd_last = odd_pairs * (t + 1) / threads;
+        double work = 0, sync = 0;
+        long int round = 0;
+        int done = 0;
+
+        while (!done) {
+            int slot = round % 3;
+
+            // Tempo de trabalho: os laços de comparação e troca; tempo de
+            // sincronização: a espera nas barreiras pelas outras threads
+            double t0 = omp_get_wtime();
+            int swapped = phase(&array[2 * even_first], even_last - even_first);
+            double t1 = omp_get_wtime();
+            #pragma omp barrier
+            double t2 = omp_get_wtime();
+
+            swapped |= phase(&array[2 * odd_first + 1], odd_last - odd_first);
+            if (swapped) {
+                #pragma omp atomic write
+                changed[slot] = 1;
+            }
+            if (t == 0) {
+                #pragma omp atomic write
+                changed[(slot + 1) % 3] = 0;
+            }
+            double t3 = omp_get_wtime();
+            #pragma omp barrier
+            double t4 = omp_get_wtime();
+            work += (t1 - t0) + (t3 - t2);
+            sync += (t2 - t1) + (t4 - t3);
+
+            int any;
+            #pragma omp atomic read
+            any = changed[slot];
+            done = !any;
+            round++;
+        }
+
+        #pragma omp critical
+        {
+            total_work += work;
+            total_sync += sync;
+        }
+        #pragma omp single
+        {
+            rounds = round;
+            team = threads;
+        }
+    }
+
+    if (statistics != NULL) {
+        statistics->rounds = rounds;
+        statistics->work_time = total_work / team;
+        statistics->sync_time = total_sync / team;
+        statistics->active_fraction = 1.0;
+    }
+}
+
+
+// Pares (i, i + 1) da fase de paridade parity com i em [first, last) e
+// i + 1 < size; first é par, então a fase par começa em first e a ímpar
+// em first + 1
+static long int chunk_pairs(long int first, long int last, long int size, int parity) {
+    long int end = (last < size - 1) ? last : size - 1;
+    return (end - first + 1 - parity) / 2;
+}
+
+
+void BubbleSort_adaptive(double *array, long int size, odd_even_statistics_t *statistics) {
+    int threads = omp_get_max_threads();
+    long int chunks = (size + ADAPTIVE_CHUNK - 1) / ADAPTIVE_CHUNK;
+    // Flags de troca por bloco em dois buffers alternados: no começo da
+    // rodada r + 1 cada thread lê as flags da rodada r dos blocos vizinhos,
+    // que podem ser de outra thread, enquanto essa outra thread já pode
+    // estar escrevendo as da rodada r + 1 dos mesmos blocos. A barreira do
+    // meio da rodada r + 1 separa essas leituras da escrita seguinte no
+    // mesmo buffer, na rodada r + 2.
+    unsigned char *dirty = (unsigned char*)malloc(2 * (chunks > 0 ? chunks : 1));
+    int changed[3] = { 0, 0, 0 };
+    double total_work = 0, total_sync = 0, total_window = 0;
+    long int rounds = 0;
+    int team = 1;
+
+    if (size < 2) {
+        threads = 1;
+        chunks = 0;
+    }
+
+    #pragma omp parallel num_threads(threads) shared(changed)
+    {
+        int t = omp_get_thread_num();
+        int count = omp_get_num_threads();
+        long int chunk_first = chunks * t / count, chunk_last = chunks * (t + 1) / count;
+        double work = 0, sync = 0, window = 0;
+        long int round = 0;
+        int done = (chunks == 0);
+
+        // Um bloco só pode ter um par fora de ordem se alguma posição dele
+        // mudou na rodada anterior, e as posições de um bloco só mudam por
+        // trocas dele mesmo ou dos dois vizinhos (o último par ímpar de cada
+        // bloco usa a primeira posição do seguinte). Um bloco em que nem
+        // ele nem os vizinhos trocaram já está estável e é pulado.
+        while (!done) {
+            int slot = round % 3;
+            const unsigned char *previous = &dirty[((round + 1) % 2) * chunks];
+            unsigned char *current = &dirty[(round % 2) * chunks];
+
+            double t0 = omp_get_wtime();
+            for (long int c = chunk_first; c < chunk_last; c++) {
+                current[c] = round == 0 || previous[c] || (c > 0 && previous[c - 1]) ||
+                             (c + 1 < chunks && previous[c + 1]);
+                if (!current[c])
+                    continue;
+                long int first = c * ADAPTIVE_CHUNK;
+                long int last = (first + ADAPTIVE_CHUNK < size) ? first + ADAPTIVE_CHUNK : size;
+                window += last - first;
+                current[c] = phase_scalar(&array[first], chunk_pairs(first, last, size, 0)) ? 2 : 1;
+            }
+            double t1 = omp_get_wtime();
+            #pragma omp barrier
+            double t2 = omp_get_wtime();
+
+            int swapped = 0;
+            for (long int c = chunk_first; c < chunk_last; c++) {
+                if (!current[c])
+                    continue;
+                long int first = c * ADAPTIVE_CHUNK;
+                long int last = (first + ADAPTIVE_CHUNK < size) ? first + ADAPTIVE_CHUNK : size;
+                int odd = phase_scalar(&array[first + 1], chunk_pairs(first, last, size, 1));
+                current[c] = (current[c] == 2) || odd;
+                swapped |= current[c];
+            }
+            if (swapped) {
+                #pragma omp atomic write
+                changed[slot] = 1;
+            }
+            if (t == 0) {
+                #pragma omp atomic write
+                changed[(slot + 1) % 3] = 0;
+            }
+            double t3 = omp_get_wtime();
+            #pragma omp barrier
+            double t4 = omp_get_wtime();
+            work += (t1 - t0) + (t3 - t2);
+            sync += (t2 - t1) + (t4 - t3);
+
+            int any;
+            #pragma omp atomic read
+            any = changed[slot];
+            done = !any;
+            round++;
+        }
+
+        #pragma omp critical
+        {
+            total_work += work;
+            total_sync += sync;
+            total_window += window;
+        }
+        #pragma omp single
+        {
+            rounds = round;
+            team = count;
+        }
+    }
+
+    if (statistics != NULL) {
+        statistics->rounds = rounds;
+        statistics->work_time = total_work / team;
+        statistics->sync_time = total_sync / team;
+        statistics->active_fraction = (rounds > 0) ? total_window / rounds / size : 0;
+    }
+    free(dirty);
+}
+
+
+void BubbleSort_persistent(double *array, long int size, odd_even_statistics_t *statistics) {
+    odd_even_sort(array, size, phase_scalar, statistics);
+}
+
+
+int BubbleSort_simd(double *array, long int size, int isa, odd_even_statistics_t *statistics) {
+    if (isa == SIMD_AUTO)
+        isa = best_simd_isa();
+    phase_kernel_t phase = phase_scalar;
+    if (isa == SIMD_AVX512)
+        phase = phase_avx512;
+    else if (isa == SIMD_AVX2)
+        phase = phase_avx2;
+    odd_even_sort(array, size, phase, statistics);
+    return isa;
+}
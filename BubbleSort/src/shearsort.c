@@ -0,0 +1,86 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <libppc.h>
+#include <omp.h>
+
+#include "bubblesort.h"
+
+// Colunas ordenadas juntas: o bloco de SHEAR_TILE colunas é copiado para um
+// buffer contíguo por coluna, então cada linha da matriz é lida em trechos
+// de SHEAR_TILE doubles em vez de um double por linha de cache
+#define SHEAR_TILE 32
+
+
+static int compare_ascending(const void *a, const void *b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+
+static int compare_descending(const void *a, const void *b) {
+    return compare_ascending(b, a);
+}
+
+
+// Linhas pares em ordem crescente, ímpares em ordem decrescente
+static void sort_rows(double *matrix, long int lines, long int columns) {
+    #pragma omp for schedule(static)
+    for (long int i = 0; i < lines; i++)
+        qsort(&M(i, 0, columns, matrix), columns, sizeof(double),
+              (i % 2 == 0) ? compare_ascending : compare_descending);
+}
+
+
+// Colunas em ordem crescente de cima para baixo, um bloco de colunas por vez
+static void sort_columns(double *matrix, long int lines, long int columns, double *tile) {
+    long int tiles = (columns + SHEAR_TILE - 1) / SHEAR_TILE;
+    #pragma omp for schedule(static)
+    for (long int b = 0; b < tiles; b++) {
+        long int first = b * SHEAR_TILE;
+        long int width = (first + SHEAR_TILE < columns) ? SHEAR_TILE : columns - first;
+        for (long int i = 0; i < lines; i++)
+            for (long int j = 0; j < width; j++)
+                tile[j * lines + i] = M(i, first + j, columns, matrix);
+        for (long int j = 0; j < width; j++)
+            qsort(&tile[j * lines], lines, sizeof(double), compare_ascending);
+        for (long int i = 0; i < lines; i++)
+            for (long int j = 0; j < width; j++)
+                M(i, first + j, columns, matrix) = tile[j * lines + i];
+    }
+}
+
+
+long int ShearSort_parallel(double *matrix, long int lines, long int columns) {
+    // Depois de cada par de fases linhas/colunas o número de linhas que
+    // ainda não estão ordenadas cai pela metade: ceil(log2 L) pares e uma
+    // última ordenação das linhas bastam
+    long int rounds = 0;
+    while ((1L << rounds) < lines)
+        rounds++;
+    if (lines < 1 || columns < 1)
+        return 0;
+
+    #pragma omp parallel
+    {
+        double *tile = (double*)malloc(sizeof(double) * SHEAR_TILE * lines);
+        for (long int r = 0; r < rounds; r++) {
+            sort_rows(matrix, lines, columns);
+            sort_columns(matrix, lines, columns, tile);
+        }
+        sort_rows(matrix, lines, columns);
+        free(tile);
+    }
+    return 2 * rounds + 1;
+}
+
+
+void snake_to_vector(const double *matrix, long int lines, long int columns, double *vector) {
+    #pragma omp parallel for schedule(static)
+    for (long int i = 0; i < lines; i++) {
+        for (long int j = 0; j < columns; j++) {
+            long int column = (i % 2 == 0) ? j : columns - 1 - j;
+            vector[i * columns + j] = M(i, column, columns, matrix);
+        }
+    }
+}
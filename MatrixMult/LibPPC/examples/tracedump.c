@@ -0,0 +1,49 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <libppc.h>
+
+/**
+ * 
+ * Mostra offline um trace gravado com trace_save: cada troca e cada fusão
+ * é refeita sobre o vetor inicial e impressa com as mesmas cores dos
+ * programas de prova, sem printf nenhum durante a execução medida.
+ * 
+ * */
+int main(int argc, char ** argv){
+
+	if ( argc < 4 ){
+
+		fprintf( stderr, "Usage: %s trace.dat vector.dat size [context]\n", argv[0] );
+
+		return 1;
+	}
+
+	long int size = atol( argv[3] );
+
+	long int context = ( argc > 4 ) ? atol( argv[4] ) : -1;
+
+	double *vector = load_double_vector( argv[2], size );
+
+	if ( vector == NULL ){
+
+		fprintf( stderr, "Could not load %ld elements from %s\n", size, argv[2] );
+
+		return 1;
+	}
+
+	long int events = trace_print( argv[1], vector, size, context, stdout );
+
+	free( vector );
+
+	if ( events < 0 ){
+
+		fprintf( stderr, "Could not read the trace %s\n", argv[1] );
+
+		return 1;
+	}
+
+	printf( "\n%ld events\n", events );
+
+	return 0;
+}
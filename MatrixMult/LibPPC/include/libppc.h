@@ -4,6 +4,8 @@
 
 
 #include <complex.h>
+#include <stddef.h>
+#include <stdio.h>
 
 /**
  *  * \brief This macro is intended to help on matrixes algorithms
@@ -161,6 +163,37 @@ int* generate_random_int_vector(long int quantity, int minvalue, int maxvalue);
 point2D_t* generate_random_2Dpoints_vector(long int quantity, double minvalue, double maxvalue);
 
 
+/**
+	\brief Saves a 2-D point vector on a specified filename (x and y of each point, in binary)
+
+	\param data pointer to the points
+	\param size number of points
+	\param filename name of the file to save the vector
+
+	\return 0 on success
+*/
+int save_2Dpoints_vector(const point2D_t *data, long int size, const char *filename );
+
+
+/**
+	\brief Loads a file containing a 2-D point vector
+
+	\param filename name of the file to load the vector
+	\param size number of points
+
+	\return a pointer on success, NULL pointer on failure
+*/
+point2D_t* load_2Dpoints_vector(const char *filename, long int size);
+
+
+/**
+ * \brief Compares two 2-D point vectors stored on files
+ * 
+ * \return 1 if the vectors are the same, 0 otherwise
+*/
+int compare_2Dpoints_vector_on_files(const char *vector_file1, const char *vector_file2);
+
+
 /**
 	\brief Compares 2 vectors stored on main memory
 
@@ -267,6 +300,412 @@ int compare_double_matrixes_on_files(const char *filename1,
 	long int number_of_columns);
 
 
+/**
+	\brief Alignment, in bytes, of every buffer allocated by LibPPC
+*/
+#define ALLOCATION_ALIGNMENT 64
+
+
+/**
+	\brief Page modes used by allocate_aligned_memory
+
+	HUGE_PAGES_TRANSPARENT asks the kernel for transparent huge pages (madvise),
+	HUGE_PAGES_EXPLICIT maps buffers from the reserved hugetlbfs pool and falls
+	back to transparent huge pages when the pool is empty.
+*/
+enum huge_page_mode_enum {
+	HUGE_PAGES_NONE = 0,
+	HUGE_PAGES_TRANSPARENT,
+	HUGE_PAGES_EXPLICIT
+};
+
+
+/**
+	\brief Selects the page mode of the next allocations
+
+	Affects every loader and generator of LibPPC. Only buffers of 2 MiB or
+	more use huge pages.
+
+	\param mode one of huge_page_mode_enum
+*/
+void set_huge_page_mode(int mode);
+
+
+/**
+	\brief Returns the current page mode
+*/
+int get_huge_page_mode(void);
+
+
+/**
+	\brief Converts "none", "thp" or "explicit" to a huge_page_mode_enum value
+
+	\return the mode, -1 if the name is unknown
+*/
+int parse_huge_page_mode(const char *name);
+
+
+/**
+	\brief Allocates memory aligned to ALLOCATION_ALIGNMENT
+
+	Used by all loaders and generators. The pointer may be released with
+	free(), except in HUGE_PAGES_EXPLICIT mode, where free_aligned_memory
+	must be used (it works in every mode).
+
+	\param bytes number of bytes to allocate
+
+	\return a pointer on success, NULL pointer on failure
+*/
+void* allocate_aligned_memory(size_t bytes);
+
+
+/**
+	\brief Releases memory returned by allocate_aligned_memory or by any
+	LibPPC loader or generator
+*/
+void free_aligned_memory(void *pointer);
+
+
+/**
+	\brief Starts counting dTLB read misses on each thread of the OpenMP team
+*/
+void start_dtlb_miss_counters(void);
+
+
+/**
+	\brief Stops the counters started by start_dtlb_miss_counters
+
+	\return the number of misses of all threads, -1 if the hardware counter
+	is not available (e.g. perf_event_paranoid or a virtual machine)
+*/
+long long stop_dtlb_miss_counters(void);
+
+
+/**
+	\brief A bump (arena) allocator for scratch memory
+
+	Allocations are released in LIFO order: arena_mark saves the current
+	position and arena_reset releases everything allocated after it. An
+	arena belongs to a single thread; use thread_arena inside OpenMP regions.
+*/
+typedef struct arena arena_t;
+
+
+/**
+	\brief Counters of the thread arenas, used to size them
+*/
+typedef struct {
+
+	// Largest amount of memory used at once by one arena
+	size_t peak_bytes;
+
+	// Allocations served by all arenas
+	long int allocations;
+
+	// Extra blocks allocated because an arena was full
+	long int overflow_blocks;
+
+	int arenas;
+
+} arena_statistics_t;
+
+
+/**
+	\brief Creates an arena with a first block of capacity bytes
+
+	When a block is full a new one (of at least the same size) is chained,
+	so capacity is only a hint: overflow_blocks shows when it is too small.
+
+	\return a pointer on success, NULL pointer on failure
+*/
+arena_t* arena_create(size_t capacity);
+
+
+/**
+	\brief Allocates bytes from the arena, aligned to ALLOCATION_ALIGNMENT
+*/
+void* arena_alloc(arena_t *arena, size_t bytes);
+
+
+/**
+	\brief Returns the current position of the arena, to be used with arena_reset
+*/
+size_t arena_mark(const arena_t *arena);
+
+
+/**
+	\brief Releases every allocation made after mark was taken
+
+	Example:
+	size_t mark = arena_mark( arena );
+	double *tmp = (double*)arena_alloc( arena, sizeof(double) * n );
+	...
+	arena_reset( arena, mark );
+*/
+void arena_reset(arena_t *arena, size_t mark);
+
+
+/**
+	\brief Frees the arena and all its blocks
+*/
+void arena_destroy(arena_t *arena);
+
+
+/**
+	\brief Sets the capacity of the thread arenas created from now on
+*/
+void set_thread_arena_capacity(size_t capacity);
+
+
+/**
+	\brief Returns the arena of the calling thread, creating it on first use
+
+	Safe inside OpenMP tasks: a tied task only leaves its thread at a task
+	scheduling point, and any task run there finishes before it resumes,
+	so marks and resets stay in LIFO order. Scratch memory must not be kept
+	across a scheduling point of an untied task.
+*/
+arena_t* thread_arena(void);
+
+
+/**
+	\brief Sums the counters of all thread arenas (peak_bytes is the maximum)
+*/
+void get_thread_arena_statistics(arena_statistics_t *statistics);
+
+
+/**
+	\brief Prints the counters of all thread arenas
+*/
+void print_thread_arena_statistics(void);
+
+
+/**
+	\brief Clears the counters of all thread arenas
+*/
+void reset_thread_arena_statistics(void);
+
+
+/**
+	\brief Frees all thread arenas; threads get a new one on the next thread_arena call
+*/
+void destroy_thread_arenas(void);
+
+
+/**
+	\brief Thread binding policies used by bind_omp_threads
+
+	BIND_COMPACT fills the CPUs of one NUMA node before moving to the next,
+	BIND_SCATTER spreads consecutive threads over the nodes in round-robin.
+*/
+enum bind_policy_enum {
+	BIND_NONE = 0,
+	BIND_COMPACT,
+	BIND_SCATTER
+};
+
+
+/**
+	\brief Allocates a double vector touched in parallel (first-touch)
+
+	Every OpenMP thread zeroes its schedule(static) chunk, so the pages of
+	each chunk are placed on the NUMA node of the thread that will use it.
+	Call it after omp_set_num_threads with the thread count of the kernel.
+
+	\param size size of the vector
+
+	\return a pointer on success, NULL pointer on failure
+*/
+double* allocate_double_vector_first_touch(long int size);
+
+
+/**
+	\brief Copies a double vector into a new first-touch vector
+
+	\param source vector to copy
+	\param size size of the vector
+
+	\return a pointer on success, NULL pointer on failure
+*/
+double* copy_double_vector_first_touch(const double *source, long int size);
+
+
+/**
+	\brief Loads a double vector into first-touch memory
+
+	Same as load_double_vector, but the pages are placed by the OpenMP
+	threads before the file is read.
+
+	\param filename name of the file to load the vector
+	\param size size of the vector
+
+	\return a pointer on success, NULL pointer on failure
+*/
+double* load_double_vector_first_touch(const char *filename, long int size);
+
+
+/**
+	\brief Loads a double matrix into first-touch memory
+
+	The matrix is touched by lines, as in a schedule(static) loop over M(i, j).
+
+	\return a pointer on success, NULL pointer on failure
+*/
+double* load_double_matrix_first_touch(const char *filename,
+	long int number_of_lines,
+	long int number_of_columns);
+
+
+/**
+	\brief Converts "none", "compact" or "scatter" to a bind_policy_enum value
+
+	\return the policy, -1 if the name is unknown
+*/
+int parse_bind_policy(const char *name);
+
+
+/**
+	\brief Binds each thread of the current OpenMP team to one CPU
+
+	Must be called again after omp_set_num_threads. BIND_NONE restores the
+	CPU set the process had when the first binding was made.
+
+	\param policy one of bind_policy_enum
+
+	\return 0 on success, the number of threads that could not be bound otherwise
+*/
+int bind_omp_threads(int policy);
+
+
+/**
+	\brief Prints the CPU and NUMA node of each OpenMP thread
+*/
+void print_omp_thread_placement(void);
+
+
+/**
+	\brief Prints how many pages of a buffer are on each NUMA node
+
+	\param data pointer to the buffer
+	\param bytes size of the buffer in bytes
+	\param label name printed before the counts
+*/
+void print_numa_placement(const void *data, long int bytes, const char *label);
+
+
+/**
+	\brief Kinds of events recorded by the trace recorder
+*/
+enum trace_event_enum {
+	// A new run starts from the initial vector (a = run number)
+	TRACE_EVENT_BEGIN = 1,
+	// array[a] and array[b] were exchanged
+	TRACE_EVENT_SWAP,
+	// array[a..b] and array[b+1..c] were merged
+	TRACE_EVENT_MERGE
+};
+
+
+/**
+	\brief One trace event, as stored in the rings and in trace files
+*/
+typedef struct {
+
+	// Seconds since trace_start (omp_get_wtime)
+	double timestamp;
+
+	long int a, b, c;
+
+	// Ring of the thread that recorded the event
+	int thread;
+
+	// One of trace_event_enum
+	int type;
+
+} trace_event_t;
+
+
+/**
+	\brief Trace macros: compiled to nothing unless __TRACE__ is defined
+
+	Build the program with CFLAGS=-D__TRACE__ (or define __TRACE__ before
+	including libppc.h) to record events; otherwise the kernels have no
+	tracing code at all.
+*/
+#ifdef __TRACE__
+#define TRACE_BEGIN(run) trace_record( TRACE_EVENT_BEGIN, (run), 0, 0 )
+#define TRACE_SWAP(i, j) trace_record( TRACE_EVENT_SWAP, (i), (j), 0 )
+#define TRACE_MERGE(left, mid, right) trace_record( TRACE_EVENT_MERGE, (left), (mid), (right) )
+#else
+#define TRACE_BEGIN(run) ((void)0)
+#define TRACE_SWAP(i, j) ((void)0)
+#define TRACE_MERGE(left, mid, right) ((void)0)
+#endif
+
+
+/**
+	\brief Starts recording events into per-thread ring buffers
+
+	Each thread that records gets its own ring on its first event (one
+	atomic increment, no locks after that) and writes only to it. A full
+	ring overwrites its oldest events; they are counted as lost.
+
+	\param threads number of rings, i.e. of threads that may record
+	\param events_per_thread capacity of each ring
+
+	\return 0 on success, -1 if the rings could not be allocated
+*/
+int trace_start(int threads, long int events_per_thread);
+
+
+/**
+	\brief Records one event; use the TRACE_* macros instead of calling it
+
+	Does nothing if no trace was started. Events of threads beyond the
+	number of rings are counted as lost.
+*/
+void trace_record(int type, long int a, long int b, long int c);
+
+
+/**
+	\brief Saves the recorded events, ordered by timestamp, on filename
+
+	The file has the number of events and of lost events (two long ints)
+	followed by the trace_event_t records.
+
+	\return the number of events saved, -1 on error
+*/
+long int trace_save(const char *filename);
+
+
+/**
+	\brief Stops recording and frees the rings
+*/
+void trace_stop(void);
+
+
+/**
+	\brief Replays a trace file over the initial vector and prints each step
+
+	Same colored view as the proof programs: for a swap, the vector before
+	(swapped elements in red) and after (in green); for a merge, the vector
+	after it with the merged range in green. A begin event restores the
+	initial vector. Merges are replayed by merging the two ranges again.
+
+	\param initial the vector the traced run started from
+	\param context elements printed on each side of the changed positions;
+	a negative value prints the whole vector
+	\param output stream to print to
+
+	\return the number of events printed, -1 if the file cannot be read
+*/
+long int trace_print(const char *trace_filename,
+	const double *initial,
+	long int size,
+	long int context,
+	FILE *output);
+
+
 #if 0
 /*
 	\brief save current matrix on the file filename
@@ -0,0 +1,148 @@
+#define __TRACE__
+
+#include <libppc.h>
+
+#include <stdlib.h>
+
+#include <stdio.h>
+
+#include <string.h>
+
+#include <omp.h>
+
+int main(){
+
+    /**
+     * Test 1: every thread records on its own ring and the saved trace is
+     * ordered by timestamp
+     * */
+
+    if ( trace_start( 4, 1000 ) != 0 )
+        return 1;
+
+    omp_set_num_threads( 4 );
+
+    #pragma omp parallel
+    {
+        for ( long int i = 0; i < 500; i++ ){
+            TRACE_SWAP( i, i + 1 );
+        }
+    }
+
+    long int threads = 0;
+
+    #pragma omp parallel
+    {
+        #pragma omp single
+        threads = omp_get_num_threads();
+    }
+
+    if ( trace_save( "trace1.test.output" ) != 500 * threads )
+        return 2;
+
+    FILE *fd = fopen( "trace1.test.output", "r" );
+
+    long int header[ 2 ];
+
+    if ( fread( header, sizeof(long int), 2, fd ) != 2 || header[ 0 ] != 500 * threads || header[ 1 ] != 0 )
+        return 3;
+
+    trace_event_t previous, event;
+
+    for ( long int e = 0; e < header[ 0 ]; e++ ){
+
+        if ( fread( &event, sizeof(trace_event_t), 1, fd ) != 1 || event.type != TRACE_EVENT_SWAP || event.b != event.a + 1 )
+            return 4;
+
+        if ( e > 0 && event.timestamp < previous.timestamp )
+            return 5;
+
+        previous = event;
+    }
+
+    fclose( fd );
+
+    /**
+     * Test 2: a full ring keeps the newest events and counts the rest as lost
+     * */
+
+    trace_start( 1, 10 );
+
+    for ( long int i = 0; i < 25; i++ ){
+        TRACE_MERGE( i, i, i + 1 );
+    }
+
+    if ( trace_save( "trace2.test.output" ) != 10 )
+        return 6;
+
+    fd = fopen( "trace2.test.output", "r" );
+
+    if ( fread( header, sizeof(long int), 2, fd ) != 2 || header[ 1 ] != 15 ||
+        fread( &event, sizeof(trace_event_t), 1, fd ) != 1 || event.a != 15 )
+        return 7;
+
+    fclose( fd );
+
+    /**
+     * Test 3: the replay of swaps and merges gets to the sorted vector
+     * */
+
+    double initial[] = { 3, 2, 1, 0 };
+
+    trace_start( 1, 100 );
+
+    TRACE_BEGIN( 1 );
+    TRACE_SWAP( 0, 1 );
+    TRACE_SWAP( 3, 2 );
+    TRACE_MERGE( 0, 1, 3 );
+
+    trace_save( "trace3.test.output" );
+
+    trace_stop();
+
+    FILE *output = fopen( "trace3.test.output.txt", "w" );
+
+    long int printed = trace_print( "trace3.test.output", initial, 4, -1, output );
+
+    fclose( output );
+
+    if ( printed != 4 )
+        return 8;
+
+    if ( trace_print( "missing.test.output", initial, 4, -1, stdout ) != -1 )
+        return 9;
+
+    /**
+     * Test 4: a merge whose middle is outside [a, c] is reported and skipped
+     * */
+
+    trace_start( 1, 100 );
+
+    TRACE_BEGIN( 1 );
+    TRACE_MERGE( 0, 7, 3 );
+    TRACE_MERGE( 2, 1, 3 );
+
+    trace_save( "trace4.test.output" );
+
+    trace_stop();
+
+    output = fopen( "trace4.test.output.txt", "w+" );
+
+    printed = trace_print( "trace4.test.output", initial, 4, -1, output );
+
+    rewind( output );
+
+    char line[ 256 ];
+    int invalid = 0;
+
+    while ( fgets( line, sizeof(line), output ) != NULL ){
+        invalid += strncmp( line, "Invalid event", 13 ) == 0;
+    }
+
+    fclose( output );
+
+    if ( printed != 3 || invalid != 2 )
+        return 10;
+
+    return 0;
+}
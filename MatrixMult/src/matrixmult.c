@@ -24,7 +24,7 @@ enum implementations_enum {
 
 double *MatrixMult_serial(const double *m1, const double *m2){
 
-    double *mR = (double*)malloc(sizeof(double) * NLINES * NCOLS);
+    double *mR = (double*)allocate_aligned_memory(sizeof(double) * NLINES * NCOLS);
 
     for (long int i = 0; i < NLINES; i++) {
         for (long int j = 0; j < NCOLS; j++) {
@@ -46,10 +46,12 @@ double *MatrixMult_serial(const double *m1, const double *m2){
 
 
 double *MatrixMult_parallel(const double *m1, const double *m2) {
-    double *mR = (double*)malloc(sizeof(double) * NLINES * NCOLS);
+    // mR é tocada pelas threads com o mesmo schedule(static) do laço abaixo,
+    // então cada bloco de linhas fica no nó NUMA da thread que o escreve.
+    double *mR = allocate_double_vector_first_touch(NLINES * NCOLS);
 
     // Cada thread trabalha com pares (i, j) diferentes.
-    #pragma omp parallel for collapse(2)
+    #pragma omp parallel for collapse(2) schedule(static)
     for (long int i = 0; i < NLINES; i++) {
         for (long int j = 0; j < NCOLS; j++) {
 
@@ -71,9 +73,57 @@ double *MatrixMult_parallel(const double *m1, const double *m2) {
 
 
 
+// Define o número de threads e aplica a política de afinidade escolhida
+void set_threads(int number_of_threads, int bind_policy) {
+    omp_set_num_threads(number_of_threads);
+    if (bind_policy != BIND_NONE && bind_omp_threads(bind_policy) != 0) {
+        printf("\nWarning: could not bind all threads");
+    }
+}
+
+
+// Imprime as falhas de dTLB medidas durante o kernel
+void print_dtlb_misses(long long misses) {
+    if (misses < 0) {
+        printf("\ndTLB misses: not available");
+    } else {
+        printf("\ndTLB misses: %lld", misses);
+    }
+}
+
+
 int main(int argc, char ** argv){
     srand( time(NULL) );
-    double *m1, *m2, *mR_serial, *mR_2, *mR_4;
+    int bind_policy = BIND_NONE;
+    int huge_page_mode = HUGE_PAGES_NONE;
+    int opt;
+    while ((opt = getopt(argc, argv, "b:p:")) != -1) {
+        switch (opt) {
+        case 'b':
+            bind_policy = parse_bind_policy(optarg);
+            if (bind_policy < 0) {
+                fprintf(stderr, "Unknown binding policy: %s\n", optarg);
+                return 1;
+            }
+            break;
+        case 'p':
+            huge_page_mode = parse_huge_page_mode(optarg);
+            if (huge_page_mode < 0) {
+                fprintf(stderr, "Unknown huge page mode: %s\n", optarg);
+                return 1;
+            }
+            break;
+        default:
+            fprintf(stderr, "Usage: %s [-b none|compact|scatter] [-p none|thp|explicit]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    // Vale para todas as matrizes alocadas pela LibPPC daqui em diante
+    set_huge_page_mode(huge_page_mode);
+
+    double *m1, *m2, *m1_parallel, *m2_parallel, *mR_serial, *mR_2, *mR_4;
+    long long tlb_misses;
     if (access("m1.dat", F_OK) != 0) {
         printf("\nGenerating new Matrix 1 values...");
         m1 = (double*)generate_random_double_matrix( NLINES, NCOLS );
@@ -91,22 +141,40 @@ int main(int argc, char ** argv){
         m2 = load_double_matrix("m2.dat", NLINES, NCOLS);
     }
     double start, end, time_serial = 0, time_parallel_2 = 0, time_parallel_4 = 0;
+    printf("\nHuge page mode: %s", huge_page_mode == HUGE_PAGES_EXPLICIT ? "explicit" :
+        (huge_page_mode == HUGE_PAGES_TRANSPARENT ? "thp" : "none"));
     printf("\nRunning serial implementation ...");
+    start_dtlb_miss_counters();
     start = omp_get_wtime();
     mR_serial = MatrixMult_serial(m1, m2);
     end = omp_get_wtime();
+    tlb_misses = stop_dtlb_miss_counters();
     time_serial = end - start;
     printf("\nSerial implementation took %.6f seconds", time_serial);
+    print_dtlb_misses(tlb_misses);
     save_double_matrix(mR_serial, NLINES, NCOLS, "mR_serial.dat");
 
     printf("\n----------------------------------------------\n");
-    omp_set_num_threads(2);
+    set_threads(2, bind_policy);
+    // Cópias first-touch das entradas: as linhas de m1 usadas por cada thread
+    // ficam no seu nó e m2, lida por todas, fica distribuída entre os nós.
+    m1_parallel = copy_double_vector_first_touch(m1, NLINES * NCOLS);
+    m2_parallel = copy_double_vector_first_touch(m2, NLINES * NCOLS);
     printf("\nRunning parallel implementation (2 threads) ...");
+    start_dtlb_miss_counters();
     start = omp_get_wtime();
-    mR_2 = MatrixMult_parallel(m1, m2);
+    mR_2 = MatrixMult_parallel(m1_parallel, m2_parallel);
     end = omp_get_wtime();
+    tlb_misses = stop_dtlb_miss_counters();
     time_parallel_2 = end - start;
     printf("\nParallel implementation took %.6f seconds (2 threads)", time_parallel_2);
+    print_dtlb_misses(tlb_misses);
+    print_omp_thread_placement();
+    print_numa_placement(m1_parallel, sizeof(double) * NLINES * NCOLS, "m1");
+    print_numa_placement(m2_parallel, sizeof(double) * NLINES * NCOLS, "m2");
+    print_numa_placement(mR_2, sizeof(double) * NLINES * NCOLS, "mR");
+    free_aligned_memory(m1_parallel);
+    free_aligned_memory(m2_parallel);
     save_double_matrix(mR_2, NLINES, NCOLS, "mR_parallel_2.dat");
     double speedup_2 = time_serial / time_parallel_2;
     double eficiencia_2 = speedup_2 / 2.0;
@@ -114,13 +182,26 @@ int main(int argc, char ** argv){
     printf("\nEficiência (2 threads): %.3f", eficiencia_2);
 
     printf("\n----------------------------------------------\n");
-    omp_set_num_threads(4);
+    set_threads(4, bind_policy);
+    // Cópias first-touch das entradas: as linhas de m1 usadas por cada thread
+    // ficam no seu nó e m2, lida por todas, fica distribuída entre os nós.
+    m1_parallel = copy_double_vector_first_touch(m1, NLINES * NCOLS);
+    m2_parallel = copy_double_vector_first_touch(m2, NLINES * NCOLS);
     printf("\nRunning parallel implementation (4 threads) ...");
+    start_dtlb_miss_counters();
     start = omp_get_wtime();
-    mR_4 = MatrixMult_parallel(m1, m2);
+    mR_4 = MatrixMult_parallel(m1_parallel, m2_parallel);
     end = omp_get_wtime();
+    tlb_misses = stop_dtlb_miss_counters();
     time_parallel_4 = end - start;
     printf("\nParallel implementation took %.6f seconds (4 threads)", time_parallel_4);
+    print_dtlb_misses(tlb_misses);
+    print_omp_thread_placement();
+    print_numa_placement(m1_parallel, sizeof(double) * NLINES * NCOLS, "m1");
+    print_numa_placement(m2_parallel, sizeof(double) * NLINES * NCOLS, "m2");
+    print_numa_placement(mR_4, sizeof(double) * NLINES * NCOLS, "mR");
+    free_aligned_memory(m1_parallel);
+    free_aligned_memory(m2_parallel);
     save_double_matrix(mR_4, NLINES, NCOLS, "mR_parallel_4.dat");
     double speedup_4 = time_serial / time_parallel_4;
     double eficiencia_4 = speedup_4 / 4.0;
@@ -151,11 +232,11 @@ int main(int argc, char ** argv){
         printf("\nERROR! Outputs are NOT equal for 4 threads!");
     }
 
-    free(m1);
-    free(m2);
-    free(mR_serial);
-    free(mR_2);
-    free(mR_4);
+    free_aligned_memory(m1);
+    free_aligned_memory(m2);
+    free_aligned_memory(mR_serial);
+    free_aligned_memory(mR_2);
+    free_aligned_memory(mR_4);
     printf("\n");
     return 0;
 }
@@ -1,8 +1,15 @@
 
 
+#define _GNU_SOURCE
+
 #include <unistd.h>
+#include <sched.h>
 #include <sys/types.h>
 #include <sys/wait.h>
+#include <sys/syscall.h>
+#include <sys/mman.h>
+#include <sys/ioctl.h>
+#include <linux/perf_event.h>
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -12,6 +19,8 @@
 
 #include <stdlib.h>
 
+#include <omp.h>
+
 #include <libppc.h>
 
 void print_double_vector(const double *data, long int size, long int line_break){
@@ -159,7 +168,7 @@ double* load_double_vector(const char *filename, long int size){
 
 	FILE *fd = NULL;
 
-	double *data = (double*)malloc(sizeof(double)*size);
+	double *data = (double*)allocate_aligned_memory( sizeof(double)*size );
 	
 	fd = fopen( filename , "rb" );
 
@@ -177,7 +186,7 @@ double* load_double_vector(const char *filename, long int size){
 			size,
 			nbytes);
 
-		free(data);
+		free_aligned_memory( data );
 
 		fclose( fd );
 
@@ -192,7 +201,7 @@ int* load_int_vector(const char *filename, long int size){
 
 	FILE *fd = NULL;
 
-	int *data = (int*)malloc(sizeof(int)*size);
+	int *data = (int*)allocate_aligned_memory( sizeof(int)*size );
 	
 	fd = fopen( filename , "rb" );
 
@@ -210,7 +219,7 @@ int* load_int_vector(const char *filename, long int size){
 			size,
 			nbytes);
 
-		free(data);
+		free_aligned_memory( data );
 
 		fclose( fd );
 
@@ -225,7 +234,7 @@ double* generate_random_double_vector(long int quantity, double minvalue, double
 {
 	srand( time(NULL) );
 
-	double *vector = (double*)malloc( sizeof(double)*quantity );
+	double *vector = (double*)allocate_aligned_memory( sizeof(double)*quantity );
 		
 	double step_range = ( ( maxvalue - minvalue ) / ( (double) RAND_MAX ) );
 
@@ -246,7 +255,7 @@ int* generate_random_int_vector(long int quantity, int minvalue, int maxvalue)
 {
 	srand( time(NULL) );
 
-	int *vector = (int*)malloc( sizeof(int)*quantity );
+	int *vector = (int*)allocate_aligned_memory( sizeof(int)*quantity );
 		
 	double step_range = ( ( maxvalue - minvalue ) / ( (double) RAND_MAX ) );
 
@@ -268,7 +277,7 @@ point2D_t* generate_random_2Dpoints_vector(long int quantity, double minvalue, d
 {
 	srand( time(NULL) );
 
-	point2D_t *vector = (point2D_t*)malloc( sizeof( point2D_t )*quantity );
+	point2D_t *vector = (point2D_t*)allocate_aligned_memory( sizeof( point2D_t )*quantity );
 		
 	double step_range = ( ( maxvalue - minvalue ) / ( (double) RAND_MAX ) );
 
@@ -289,6 +298,110 @@ point2D_t* generate_random_2Dpoints_vector(long int quantity, double minvalue, d
 
 
 
+int save_2Dpoints_vector(const point2D_t *data, long int size, const char *filename ){
+
+	FILE *fd = fopen( filename , "wb" );
+
+	if ( fd == NULL ){
+
+		fprintf(stderr, "Error: could not create %s\n", filename );
+
+		return -1;
+	}
+
+	long int npoints = fwrite( data , sizeof(point2D_t), size , fd );
+
+	fclose( fd );
+
+	if ( npoints != size ) {
+
+		fprintf(stderr, "Error: saved size (%ld) is not the requested size (%ld)",
+			npoints,
+			size );
+
+		return npoints;
+	}
+
+	return 0;
+}
+
+
+point2D_t* load_2Dpoints_vector(const char *filename, long int size){
+
+	FILE *fd = fopen( filename , "rb" );
+
+	if ( fd == NULL ){
+
+		return NULL;
+	}
+
+	point2D_t *data = (point2D_t*)allocate_aligned_memory( sizeof(point2D_t)*size );
+
+	long int npoints = fread( data , sizeof(point2D_t), size, fd );
+
+	fclose( fd );
+
+	if ( npoints != size ){
+
+		fprintf(stderr, "Error: requested vector size (%ld) is not the size read (%ld)",
+			size,
+			npoints);
+
+		free_aligned_memory( data );
+
+		return NULL;
+	}
+
+	return data;
+}
+
+
+int compare_2Dpoints_vector_on_files(const char *vector_file1, const char *vector_file2)
+{
+	FILE *vector1_fp = fopen(vector_file1, "rb");
+	FILE *vector2_fp = fopen(vector_file2, "rb");
+
+	int files_are_equal = ( vector1_fp != NULL && vector2_fp != NULL );
+
+	// 256 points (4 KiB) per read on each file
+	point2D_t *file1_buffer = (point2D_t*)malloc( sizeof(point2D_t) * 256 );
+	point2D_t *file2_buffer = (point2D_t*)malloc( sizeof(point2D_t) * 256 );
+
+	while ( files_are_equal ) {
+
+		size_t npoints_file1 = fread( file1_buffer, sizeof(point2D_t), 256, vector1_fp );
+		size_t npoints_file2 = fread( file2_buffer, sizeof(point2D_t), 256, vector2_fp );
+
+		if ( npoints_file1 != npoints_file2 ){
+			// Files have different number of points
+			files_are_equal = 0;
+			break;
+		}
+
+		if ( npoints_file1 == 0 ){
+			break;
+		}
+
+		for ( size_t i = 0; i < npoints_file1; i++ ){
+
+			if ( file1_buffer[ i ].x != file2_buffer[ i ].x || file1_buffer[ i ].y != file2_buffer[ i ].y ){
+
+				files_are_equal = 0;
+				break;
+			}
+		}
+	}
+
+	free( file1_buffer );
+	free( file2_buffer );
+
+	if ( vector1_fp != NULL ) fclose( vector1_fp );
+	if ( vector2_fp != NULL ) fclose( vector2_fp );
+
+	return files_are_equal;
+}
+
+
 int compare_double_vectors( 
 	const double *vector1,
 	const double *vector2,
@@ -505,7 +618,7 @@ double* generate_random_double_matrix(
 	long int lines, 
 	long int columns)
 {
-	double *matrix = (double*)malloc( sizeof(double) * lines * columns );
+	double *matrix = (double*)allocate_aligned_memory( sizeof(double) * lines * columns );
 
 	for ( long int i = 0; i < lines; i++ ){
 
@@ -584,7 +697,7 @@ double* load_double_matrix( const char *filename,
 
 	size_t size = number_of_lines * number_of_columns;
 
-	double *matrix=(double*)malloc( size*sizeof(double) );
+	double *matrix=(double*)allocate_aligned_memory( size*sizeof(double) );
 
 	int nbytes = fread( matrix , sizeof(double), size, fd );
 
@@ -740,6 +853,1270 @@ int compare_double_matrixes_on_files(const char *matrix_file1,
 
 
 
+/*
+ * Aligned allocation
+ *
+ * Every vector and matrix returned by LibPPC comes from allocate_aligned_memory.
+ * Buffers are 64-byte aligned (one cache line, one AVX-512 register), so vector
+ * loads never split across lines. With HUGE_PAGES_TRANSPARENT big buffers are
+ * aligned to 2 MiB and marked with MADV_HUGEPAGE; with HUGE_PAGES_EXPLICIT they
+ * are mapped from the hugetlbfs pool (MAP_HUGETLB) and must be released with
+ * free_aligned_memory. In the other modes free() also works.
+ */
+
+#define HUGE_PAGE_SIZE ( 2L * 1024 * 1024 )
+
+// Maximum number of threads with a dTLB counter open
+#define MAX_COUNTER_THREADS 256
+
+static int huge_page_mode = HUGE_PAGES_NONE;
+
+// Buffers mapped with MAP_HUGETLB, which can not be released with free()
+typedef struct huge_page_mapping {
+
+	void *address;
+	size_t bytes;
+	struct huge_page_mapping *next;
+
+} huge_page_mapping_t;
+
+static huge_page_mapping_t *huge_page_mappings = NULL;
+
+static int dtlb_counter_fds[ MAX_COUNTER_THREADS ];
+static int dtlb_counter_threads = 0;
+
+
+void set_huge_page_mode(int mode)
+{
+	huge_page_mode = mode;
+}
+
+
+int get_huge_page_mode(void)
+{
+	return huge_page_mode;
+}
+
+
+int parse_huge_page_mode(const char *name)
+{
+	if ( strcmp( name, "none" ) == 0 ){
+		return HUGE_PAGES_NONE;
+	}
+
+	if ( strcmp( name, "thp" ) == 0 ){
+		return HUGE_PAGES_TRANSPARENT;
+	}
+
+	if ( strcmp( name, "explicit" ) == 0 ){
+		return HUGE_PAGES_EXPLICIT;
+	}
+
+	return -1;
+}
+
+
+static void* allocate_transparent_huge_pages(size_t bytes)
+{
+	void *pointer = NULL;
+
+	size_t rounded_bytes = ( bytes + HUGE_PAGE_SIZE - 1 ) & ~( HUGE_PAGE_SIZE - 1 );
+
+	if ( posix_memalign( &pointer, HUGE_PAGE_SIZE, rounded_bytes ) != 0 ){
+		return NULL;
+	}
+
+	// Only a hint: the kernel may still use 4 KiB pages
+	madvise( pointer, rounded_bytes, MADV_HUGEPAGE );
+
+	return pointer;
+}
+
+
+void* allocate_aligned_memory(size_t bytes)
+{
+	void *pointer = NULL;
+
+	if ( bytes == 0 ){
+		bytes = ALLOCATION_ALIGNMENT;
+	}
+
+	// Small buffers would waste most of a huge page
+	if ( huge_page_mode != HUGE_PAGES_NONE && bytes >= HUGE_PAGE_SIZE ){
+
+		if ( huge_page_mode == HUGE_PAGES_EXPLICIT ){
+
+			size_t rounded_bytes = ( bytes + HUGE_PAGE_SIZE - 1 ) & ~( HUGE_PAGE_SIZE - 1 );
+
+			pointer = mmap( NULL, rounded_bytes,
+				PROT_READ | PROT_WRITE,
+				MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB,
+				-1, 0 );
+
+			if ( pointer != MAP_FAILED ){
+
+				huge_page_mapping_t *mapping = (huge_page_mapping_t*)malloc( sizeof(huge_page_mapping_t) );
+
+				mapping->address = pointer;
+				mapping->bytes = rounded_bytes;
+
+				#pragma omp critical (huge_page_mappings)
+				{
+					mapping->next = huge_page_mappings;
+					huge_page_mappings = mapping;
+				}
+
+				return pointer;
+			}
+
+			fprintf(stderr, "Warning: no explicit huge pages available (see /proc/sys/vm/nr_hugepages), using transparent huge pages\n");
+		}
+
+		pointer = allocate_transparent_huge_pages( bytes );
+
+		if ( pointer != NULL ){
+			return pointer;
+		}
+	}
+
+	if ( posix_memalign( &pointer, ALLOCATION_ALIGNMENT, bytes ) != 0 ){
+
+		fprintf(stderr, "Error: could not allocate %zu bytes", bytes);
+
+		return NULL;
+	}
+
+	return pointer;
+}
+
+
+void free_aligned_memory(void *pointer)
+{
+	if ( pointer == NULL ){
+		return;
+	}
+
+	huge_page_mapping_t *mapping = NULL;
+
+	#pragma omp critical (huge_page_mappings)
+	{
+		huge_page_mapping_t **link = &huge_page_mappings;
+
+		while ( *link != NULL && (*link)->address != pointer ){
+			link = &(*link)->next;
+		}
+
+		if ( *link != NULL ){
+
+			mapping = *link;
+
+			*link = mapping->next;
+		}
+	}
+
+	if ( mapping != NULL ){
+
+		munmap( mapping->address, mapping->bytes );
+
+		free( mapping );
+
+	} else {
+
+		free( pointer );
+
+	}
+}
+
+
+void start_dtlb_miss_counters(void)
+{
+	struct perf_event_attr attributes;
+
+	memset( &attributes, 0, sizeof(attributes) );
+
+	attributes.type = PERF_TYPE_HW_CACHE;
+	attributes.size = sizeof(attributes);
+	attributes.config = PERF_COUNT_HW_CACHE_DTLB |
+		( PERF_COUNT_HW_CACHE_OP_READ << 8 ) |
+		( PERF_COUNT_HW_CACHE_RESULT_MISS << 16 );
+	attributes.disabled = 1;
+	attributes.exclude_kernel = 1;
+	attributes.exclude_hv = 1;
+
+	dtlb_counter_threads = omp_get_max_threads();
+
+	if ( dtlb_counter_threads > MAX_COUNTER_THREADS ){
+		dtlb_counter_threads = MAX_COUNTER_THREADS;
+	}
+
+	// A counter opened with pid 0 follows only the calling thread, so each
+	// thread of the team opens its own
+	#pragma omp parallel num_threads( dtlb_counter_threads )
+	{
+		int fd = syscall( SYS_perf_event_open, &attributes, 0, -1, -1, 0 );
+
+		dtlb_counter_fds[ omp_get_thread_num() ] = fd;
+
+		if ( fd >= 0 ){
+			ioctl( fd, PERF_EVENT_IOC_RESET, 0 );
+			ioctl( fd, PERF_EVENT_IOC_ENABLE, 0 );
+		}
+	}
+}
+
+
+long long stop_dtlb_miss_counters(void)
+{
+	long long total = 0;
+
+	int unavailable = 0;
+
+	for ( int t = 0; t < dtlb_counter_threads; t++ ){
+
+		long long count = 0;
+
+		int fd = dtlb_counter_fds[ t ];
+
+		if ( fd < 0 ){
+
+			unavailable = 1;
+
+			continue;
+		}
+
+		ioctl( fd, PERF_EVENT_IOC_DISABLE, 0 );
+
+		if ( read( fd, &count, sizeof(count) ) == sizeof(count) ){
+			total += count;
+		} else {
+			unavailable = 1;
+		}
+
+		close( fd );
+	}
+
+	dtlb_counter_threads = 0;
+
+	return unavailable ? -1 : total;
+}
+
+
+
+
+/*
+ * Arena allocator
+ *
+ * A bump allocator for the scratch memory of recursive kernels. Memory is
+ * released in LIFO order with arena_mark/arena_reset, so a recursion level
+ * frees everything allocated below it in one step. When the current block is
+ * full a new one is chained; blocks above a mark are freed on reset.
+ */
+
+#define DEFAULT_THREAD_ARENA_CAPACITY ( 1024L * 1024 )
+
+typedef struct arena_block {
+
+	struct arena_block *previous;
+
+	// Offset of the first byte of the block, counting all previous blocks
+	size_t start;
+
+	size_t capacity;
+	size_t used;
+
+	char *data;
+
+} arena_block_t;
+
+struct arena {
+
+	arena_block_t *current;
+
+	size_t block_size;
+
+	size_t peak_bytes;
+	long int allocations;
+	long int overflow_blocks;
+
+	// Used by the thread arenas only
+	struct arena *next_thread_arena;
+
+};
+
+static size_t thread_arena_capacity = DEFAULT_THREAD_ARENA_CAPACITY;
+
+// All thread arenas, for the statistics and destroy_thread_arenas
+static arena_t *thread_arenas = NULL;
+static long int thread_arenas_generation = 0;
+
+static __thread arena_t *current_thread_arena = NULL;
+static __thread long int current_thread_arena_generation = -1;
+
+
+static arena_block_t* create_arena_block(size_t capacity, size_t start, arena_block_t *previous)
+{
+	arena_block_t *block = (arena_block_t*)malloc( sizeof(arena_block_t) );
+
+	block->data = (char*)allocate_aligned_memory( capacity );
+
+	if ( block->data == NULL ){
+
+		free( block );
+
+		return NULL;
+	}
+
+	block->previous = previous;
+	block->start = start;
+	block->capacity = capacity;
+	block->used = 0;
+
+	return block;
+}
+
+
+arena_t* arena_create(size_t capacity)
+{
+	arena_t *arena = (arena_t*)calloc( 1, sizeof(arena_t) );
+
+	arena->block_size = capacity > 0 ? capacity : DEFAULT_THREAD_ARENA_CAPACITY;
+
+	arena->current = create_arena_block( arena->block_size, 0, NULL );
+
+	if ( arena->current == NULL ){
+
+		free( arena );
+
+		return NULL;
+	}
+
+	return arena;
+}
+
+
+void* arena_alloc(arena_t *arena, size_t bytes)
+{
+	// Keeps every allocation aligned like the block itself
+	bytes = ( bytes + ALLOCATION_ALIGNMENT - 1 ) & ~( (size_t)ALLOCATION_ALIGNMENT - 1 );
+
+	arena_block_t *block = arena->current;
+
+	if ( block->used + bytes > block->capacity ){
+
+		size_t capacity = bytes > arena->block_size ? bytes : arena->block_size;
+
+		// The unused tail of the full block counts as used until a reset
+		block = create_arena_block( capacity, block->start + block->capacity, block );
+
+		if ( block == NULL ){
+			return NULL;
+		}
+
+		arena->current = block;
+
+		arena->overflow_blocks++;
+	}
+
+	void *pointer = block->data + block->used;
+
+	block->used += bytes;
+
+	if ( block->start + block->used > arena->peak_bytes ){
+		arena->peak_bytes = block->start + block->used;
+	}
+
+	arena->allocations++;
+
+	return pointer;
+}
+
+
+size_t arena_mark(const arena_t *arena)
+{
+	return arena->current->start + arena->current->used;
+}
+
+
+void arena_reset(arena_t *arena, size_t mark)
+{
+	while ( arena->current->start > mark && arena->current->previous != NULL ){
+
+		arena_block_t *block = arena->current;
+
+		arena->current = block->previous;
+
+		free_aligned_memory( block->data );
+
+		free( block );
+	}
+
+	arena->current->used = mark - arena->current->start;
+}
+
+
+void arena_destroy(arena_t *arena)
+{
+	arena_reset( arena, 0 );
+
+	free_aligned_memory( arena->current->data );
+
+	free( arena->current );
+
+	free( arena );
+}
+
+
+void set_thread_arena_capacity(size_t capacity)
+{
+	thread_arena_capacity = capacity;
+}
+
+
+arena_t* thread_arena(void)
+{
+	// Arenas from before the last destroy_thread_arenas are already freed,
+	// so the generation is kept by the thread and not read from the arena
+	if ( current_thread_arena != NULL && current_thread_arena_generation == thread_arenas_generation ){
+		return current_thread_arena;
+	}
+
+	arena_t *arena = arena_create( thread_arena_capacity );
+
+	if ( arena == NULL ){
+		return NULL;
+	}
+
+	long int generation;
+
+	#pragma omp critical (thread_arenas)
+	{
+		generation = thread_arenas_generation;
+		arena->next_thread_arena = thread_arenas;
+		thread_arenas = arena;
+	}
+
+	current_thread_arena = arena;
+	current_thread_arena_generation = generation;
+
+	return arena;
+}
+
+
+void get_thread_arena_statistics(arena_statistics_t *statistics)
+{
+	memset( statistics, 0, sizeof(arena_statistics_t) );
+
+	#pragma omp critical (thread_arenas)
+	{
+		for ( arena_t *arena = thread_arenas; arena != NULL; arena = arena->next_thread_arena ){
+
+			if ( arena->peak_bytes > statistics->peak_bytes ){
+				statistics->peak_bytes = arena->peak_bytes;
+			}
+
+			statistics->allocations += arena->allocations;
+			statistics->overflow_blocks += arena->overflow_blocks;
+			statistics->arenas++;
+		}
+	}
+}
+
+
+void print_thread_arena_statistics(void)
+{
+	arena_statistics_t statistics;
+
+	get_thread_arena_statistics( &statistics );
+
+	fprintf(stdout, "\nArenas: %d | peak: %zu bytes | allocations: %ld | overflow blocks: %ld",
+		statistics.arenas,
+		statistics.peak_bytes,
+		statistics.allocations,
+		statistics.overflow_blocks);
+}
+
+
+void reset_thread_arena_statistics(void)
+{
+	#pragma omp critical (thread_arenas)
+	{
+		for ( arena_t *arena = thread_arenas; arena != NULL; arena = arena->next_thread_arena ){
+
+			arena->peak_bytes = arena_mark( arena );
+			arena->allocations = 0;
+			arena->overflow_blocks = 0;
+		}
+	}
+}
+
+
+void destroy_thread_arenas(void)
+{
+	#pragma omp critical (thread_arenas)
+	{
+		while ( thread_arenas != NULL ){
+
+			arena_t *arena = thread_arenas;
+
+			thread_arenas = arena->next_thread_arena;
+
+			arena_destroy( arena );
+		}
+
+		thread_arenas_generation++;
+	}
+}
+
+
+
+
+/*
+ * NUMA helpers
+ *
+ * Linux places a page on the node of the thread that writes it first. The
+ * functions below touch the memory from the OpenMP threads using the same
+ * schedule(static) of the kernels, so each thread finds its chunk on its
+ * own node instead of on the node of the main thread.
+ */
+
+#define MAX_NUMA_NODES 64
+
+// Number of pages queried on each move_pages call
+#define NUMA_QUERY_BATCH 1024
+
+// Topology loaded from sysfs on the first call to bind_omp_threads
+static int numa_topology_loaded = 0;
+static int number_of_numa_nodes = 1;
+static int cpu_to_node[ CPU_SETSIZE ];
+static int compact_cpu_order[ CPU_SETSIZE ];
+static int scatter_cpu_order[ CPU_SETSIZE ];
+static int number_of_allowed_cpus = 0;
+static cpu_set_t initial_cpu_set;
+
+
+double* allocate_double_vector_first_touch(long int size)
+{
+	double *data = (double*)allocate_aligned_memory( sizeof(double)*size );
+
+	if ( data == NULL ){
+
+		fprintf(stderr, "Error: could not allocate a vector of %ld doubles", size);
+
+		return NULL;
+	}
+
+	#pragma omp parallel for schedule(static)
+	for ( long int i = 0; i < size; i++ ){
+
+		data[ i ] = 0.0;
+
+	}
+
+	return data;
+}
+
+
+double* copy_double_vector_first_touch(const double *source, long int size)
+{
+	double *data = (double*)allocate_aligned_memory( sizeof(double)*size );
+
+	if ( data == NULL ){
+
+		fprintf(stderr, "Error: could not allocate a vector of %ld doubles", size);
+
+		return NULL;
+	}
+
+	#pragma omp parallel for schedule(static)
+	for ( long int i = 0; i < size; i++ ){
+
+		data[ i ] = source[ i ];
+
+	}
+
+	return data;
+}
+
+
+double* load_double_vector_first_touch(const char *filename, long int size)
+{
+	FILE *fd = fopen( filename , "rb" );
+
+	if ( fd == NULL ){
+
+		fprintf(stderr, "Error: could not open %s", filename);
+
+		return NULL;
+	}
+
+	// Pages are already placed when fread writes on them
+	double *data = allocate_double_vector_first_touch( size );
+
+	if ( data == NULL ){
+
+		fclose( fd );
+
+		return NULL;
+	}
+
+	long int nread = fread( data , sizeof(double), size, fd );
+
+	fclose( fd );
+
+	if ( nread != size ){
+
+		fprintf(stderr, "Error: requested vector size (%ld) is not the size read (%ld)",
+			size,
+			nread);
+
+		free_aligned_memory( data );
+
+		return NULL;
+	}
+
+	return data;
+}
+
+
+double* load_double_matrix_first_touch(const char *filename,
+	long int number_of_lines,
+	long int number_of_columns)
+{
+	return load_double_vector_first_touch( filename, number_of_lines * number_of_columns );
+}
+
+
+static int parse_cpu_list(const char *list, int node)
+{
+	const char *p = list;
+
+	while ( *p != '\0' && *p != '\n' ){
+
+		char *end;
+
+		long first = strtol( p, &end, 10 );
+
+		if ( end == p ){
+			return -1;
+		}
+
+		long last = first;
+
+		p = end;
+
+		if ( *p == '-' ){
+
+			last = strtol( p + 1, &end, 10 );
+
+			p = end;
+		}
+
+		for ( long cpu = first; cpu <= last && cpu < CPU_SETSIZE; cpu++ ){
+
+			cpu_to_node[ cpu ] = node;
+
+		}
+
+		if ( *p == ',' ){
+			p++;
+		}
+	}
+
+	return 0;
+}
+
+
+static int load_numa_topology(void)
+{
+	if ( numa_topology_loaded ){
+		return 0;
+	}
+
+	// The main thread is also bound, so the allowed set must be saved before
+	if ( sched_getaffinity( 0, sizeof(cpu_set_t), &initial_cpu_set ) != 0 ){
+
+		perror("Error: could not read the CPU affinity");
+
+		return -1;
+	}
+
+	for ( int cpu = 0; cpu < CPU_SETSIZE; cpu++ ){
+		cpu_to_node[ cpu ] = 0;
+	}
+
+	number_of_numa_nodes = 1;
+
+	for ( int node = 0; node < MAX_NUMA_NODES; node++ ){
+
+		char path[ 128 ], list[ 4096 ];
+
+		snprintf( path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node );
+
+		FILE *fd = fopen( path, "r" );
+
+		if ( fd == NULL ){
+			continue;
+		}
+
+		if ( fgets( list, sizeof(list), fd ) != NULL && parse_cpu_list( list, node ) == 0 ){
+
+			if ( node + 1 > number_of_numa_nodes ){
+				number_of_numa_nodes = node + 1;
+			}
+		}
+
+		fclose( fd );
+	}
+
+	// Compact: all CPUs of node 0, then node 1, ...
+	number_of_allowed_cpus = 0;
+
+	for ( int node = 0; node < number_of_numa_nodes; node++ ){
+
+		for ( int cpu = 0; cpu < CPU_SETSIZE; cpu++ ){
+
+			if ( CPU_ISSET( cpu, &initial_cpu_set ) && cpu_to_node[ cpu ] == node ){
+
+				compact_cpu_order[ number_of_allowed_cpus++ ] = cpu;
+
+			}
+		}
+	}
+
+	if ( number_of_allowed_cpus == 0 ){
+		return -1;
+	}
+
+	// Scatter: one CPU of each node in turn
+	int next_cpu_of_node[ MAX_NUMA_NODES ] = { 0 };
+	int scattered = 0;
+
+	while ( scattered < number_of_allowed_cpus ){
+
+		for ( int node = 0; node < number_of_numa_nodes; node++ ){
+
+			int seen = 0;
+
+			for ( int i = 0; i < number_of_allowed_cpus; i++ ){
+
+				int cpu = compact_cpu_order[ i ];
+
+				if ( cpu_to_node[ cpu ] != node ){
+					continue;
+				}
+
+				if ( seen++ == next_cpu_of_node[ node ] ){
+
+					scatter_cpu_order[ scattered++ ] = cpu;
+
+					next_cpu_of_node[ node ]++;
+
+					break;
+				}
+			}
+		}
+	}
+
+	numa_topology_loaded = 1;
+
+	return 0;
+}
+
+
+int parse_bind_policy(const char *name)
+{
+	if ( strcmp( name, "none" ) == 0 ){
+		return BIND_NONE;
+	}
+
+	if ( strcmp( name, "compact" ) == 0 ){
+		return BIND_COMPACT;
+	}
+
+	if ( strcmp( name, "scatter" ) == 0 ){
+		return BIND_SCATTER;
+	}
+
+	return -1;
+}
+
+
+int bind_omp_threads(int policy)
+{
+	if ( load_numa_topology() != 0 ){
+		return -1;
+	}
+
+	int failures = 0;
+
+	#pragma omp parallel reduction(+:failures)
+	{
+		cpu_set_t cpu_set;
+
+		if ( policy == BIND_NONE ){
+
+			cpu_set = initial_cpu_set;
+
+		} else {
+
+			const int *order = ( policy == BIND_SCATTER ) ? scatter_cpu_order : compact_cpu_order;
+
+			CPU_ZERO( &cpu_set );
+			CPU_SET( order[ omp_get_thread_num() % number_of_allowed_cpus ], &cpu_set );
+
+		}
+
+		// pid 0 binds only the calling thread
+		if ( sched_setaffinity( 0, sizeof(cpu_set_t), &cpu_set ) != 0 ){
+			failures++;
+		}
+	}
+
+	return failures;
+}
+
+
+void print_omp_thread_placement(void)
+{
+	load_numa_topology();
+
+	int number_of_threads = omp_get_max_threads();
+
+	int *cpus = (int*)malloc( sizeof(int) * number_of_threads );
+
+	for ( int t = 0; t < number_of_threads; t++ ){
+		cpus[ t ] = -1;
+	}
+
+	#pragma omp parallel
+	{
+		cpus[ omp_get_thread_num() ] = sched_getcpu();
+	}
+
+	for ( int t = 0; t < number_of_threads; t++ ){
+
+		if ( cpus[ t ] >= 0 && cpus[ t ] < CPU_SETSIZE ){
+
+			fprintf(stdout, "\nThread %d: cpu %d (node %d)", t, cpus[ t ], cpu_to_node[ cpus[ t ] ]);
+
+		} else {
+
+			fprintf(stdout, "\nThread %d: cpu unknown", t);
+
+		}
+	}
+
+	free( cpus );
+}
+
+
+void print_numa_placement(const void *data, long int bytes, const char *label)
+{
+	long int page_size = sysconf( _SC_PAGESIZE );
+
+	unsigned long first_page = (unsigned long)data & ~( page_size - 1 );
+
+	long int number_of_pages = ( (unsigned long)data + bytes - first_page + page_size - 1 ) / page_size;
+
+	long int pages_on_node[ MAX_NUMA_NODES ] = { 0 };
+	long int pages_not_present = 0;
+
+	void *pages[ NUMA_QUERY_BATCH ];
+	int status[ NUMA_QUERY_BATCH ];
+
+	for ( long int p = 0; p < number_of_pages; p += NUMA_QUERY_BATCH ){
+
+		long int count = number_of_pages - p;
+
+		if ( count > NUMA_QUERY_BATCH ){
+			count = NUMA_QUERY_BATCH;
+		}
+
+		for ( long int i = 0; i < count; i++ ){
+			pages[ i ] = (void*)( first_page + ( p + i ) * page_size );
+		}
+
+		// With a NULL node list move_pages only reports where each page is
+		if ( syscall( SYS_move_pages, 0, count, pages, NULL, status, 0 ) != 0 ){
+
+			fprintf(stdout, "\n%s: NUMA placement not available", label);
+
+			return;
+		}
+
+		for ( long int i = 0; i < count; i++ ){
+
+			if ( status[ i ] >= 0 && status[ i ] < MAX_NUMA_NODES ){
+				pages_on_node[ status[ i ] ]++;
+			} else {
+				pages_not_present++;
+			}
+		}
+	}
+
+	fprintf(stdout, "\n%s: %ld pages", label, number_of_pages);
+
+	for ( int node = 0; node < MAX_NUMA_NODES; node++ ){
+
+		if ( pages_on_node[ node ] > 0 ){
+
+			fprintf(stdout, " | node %d: %ld (%.1f%%)",
+				node,
+				pages_on_node[ node ],
+				100.0 * pages_on_node[ node ] / number_of_pages);
+
+		}
+	}
+
+	if ( pages_not_present > 0 ){
+		fprintf(stdout, " | not present: %ld", pages_not_present);
+	}
+}
+
+
+
+
+/**
+	Trace recorder: one ring per recording thread, padded to a cache line so
+	that the counters of different threads never share one
+*/
+typedef struct {
+
+	trace_event_t *events;
+
+	// Events ever recorded on this ring; the slot is head % capacity
+	long int head;
+
+	char padding[ ALLOCATION_ALIGNMENT - sizeof(trace_event_t*) - sizeof(long int) ];
+
+} trace_ring_t;
+
+static trace_ring_t *trace_rings = NULL;
+static int trace_number_of_rings = 0;
+static int trace_rings_taken = 0;
+static long int trace_capacity = 0;
+static long int trace_lost = 0;
+static long int trace_generation = 0;
+static double trace_origin = 0;
+
+static __thread trace_ring_t *current_trace_ring = NULL;
+static __thread long int current_trace_generation = -1;
+
+
+int trace_start(int threads, long int events_per_thread)
+{
+	trace_stop();
+
+	if ( threads < 1 || events_per_thread < 1 ){
+		return -1;
+	}
+
+	trace_rings = (trace_ring_t*)allocate_aligned_memory( sizeof(trace_ring_t) * threads );
+
+	if ( trace_rings == NULL ){
+		return -1;
+	}
+
+	for ( int t = 0; t < threads; t++ ){
+
+		trace_rings[ t ].head = 0;
+
+		trace_rings[ t ].events = (trace_event_t*)allocate_aligned_memory( sizeof(trace_event_t) * events_per_thread );
+
+		if ( trace_rings[ t ].events == NULL ){
+
+			trace_number_of_rings = t;
+
+			trace_stop();
+
+			return -1;
+		}
+
+		// Touches the ring now, so page faults do not show up in the trace
+		memset( trace_rings[ t ].events, 0, sizeof(trace_event_t) * events_per_thread );
+	}
+
+	trace_number_of_rings = threads;
+	trace_rings_taken = 0;
+	trace_capacity = events_per_thread;
+	trace_lost = 0;
+	trace_origin = omp_get_wtime();
+
+	return 0;
+}
+
+
+void trace_record(int type, long int a, long int b, long int c)
+{
+	if ( trace_rings == NULL ){
+		return;
+	}
+
+	// Rings from before the last trace_start belong to another trace
+	if ( current_trace_generation != trace_generation ){
+
+		int ring;
+
+		#pragma omp atomic capture
+		ring = trace_rings_taken++;
+
+		current_trace_ring = ( ring < trace_number_of_rings ) ? &trace_rings[ ring ] : NULL;
+
+		current_trace_generation = trace_generation;
+	}
+
+	trace_ring_t *ring = current_trace_ring;
+
+	if ( ring == NULL ){
+
+		#pragma omp atomic
+		trace_lost++;
+
+		return;
+	}
+
+	trace_event_t *event = &ring->events[ ring->head % trace_capacity ];
+
+	event->timestamp = omp_get_wtime() - trace_origin;
+	event->a = a;
+	event->b = b;
+	event->c = c;
+	event->thread = (int)( ring - trace_rings );
+	event->type = type;
+
+	ring->head++;
+}
+
+
+static int compare_trace_events(const void *a, const void *b)
+{
+	const trace_event_t *x = (const trace_event_t*)a, *y = (const trace_event_t*)b;
+
+	if ( x->timestamp != y->timestamp ){
+		return ( x->timestamp > y->timestamp ) - ( x->timestamp < y->timestamp );
+	}
+
+	return x->thread - y->thread;
+}
+
+
+long int trace_save(const char *filename)
+{
+	long int count = 0, lost = trace_lost;
+
+	for ( int t = 0; t < trace_number_of_rings; t++ ){
+
+		long int head = trace_rings[ t ].head;
+
+		count += ( head < trace_capacity ) ? head : trace_capacity;
+
+		lost += ( head > trace_capacity ) ? head - trace_capacity : 0;
+	}
+
+	trace_event_t *events = (trace_event_t*)malloc( sizeof(trace_event_t) * ( count > 0 ? count : 1 ) );
+
+	long int n = 0;
+
+	// Oldest event still in each ring first; events of one ring are already
+	// in time order, the sort only interleaves the rings
+	for ( int t = 0; t < trace_number_of_rings; t++ ){
+
+		long int head = trace_rings[ t ].head;
+
+		for ( long int e = ( head > trace_capacity ) ? head - trace_capacity : 0; e < head; e++ ){
+			events[ n++ ] = trace_rings[ t ].events[ e % trace_capacity ];
+		}
+	}
+
+	qsort( events, count, sizeof(trace_event_t), compare_trace_events );
+
+	FILE *fd = fopen( filename, "w" );
+
+	if ( fd == NULL ){
+
+		free( events );
+
+		return -1;
+	}
+
+	int ok = fwrite( &count, sizeof(long int), 1, fd ) == 1 &&
+		fwrite( &lost, sizeof(long int), 1, fd ) == 1 &&
+		(long int)fwrite( events, sizeof(trace_event_t), count, fd ) == count;
+
+	fclose( fd );
+
+	free( events );
+
+	return ok ? count : -1;
+}
+
+
+void trace_stop(void)
+{
+	if ( trace_rings != NULL ){
+
+		for ( int t = 0; t < trace_number_of_rings; t++ ){
+			free_aligned_memory( trace_rings[ t ].events );
+		}
+
+		free_aligned_memory( trace_rings );
+	}
+
+	trace_rings = NULL;
+	trace_number_of_rings = 0;
+	trace_generation++;
+}
+
+
+// Prints array around [low, high] with low and high (or, with whole_range,
+// every position between them) in color
+static void print_trace_window(FILE *output, const char *label, const double *array, long int size,
+	long int low, long int high, int whole_range, long int context, const char *color)
+{
+	long int first = 0, last = size;
+
+	if ( context >= 0 ){
+		first = ( low - context > 0 ) ? low - context : 0;
+		last = ( high + context + 1 < size ) ? high + context + 1 : size;
+	}
+
+	fprintf( output, "%s[", label );
+
+	if ( first > 0 ){
+		fprintf( output, "... " );
+	}
+
+	for ( long int j = first; j < last; j++ ){
+
+		if ( j == low || j == high || ( whole_range && j > low && j < high ) ){
+			fprintf( output, "\033[%sm%.2f\033[0m", color, array[ j ] );
+		} else {
+			fprintf( output, "%.2f", array[ j ] );
+		}
+
+		if ( j < last - 1 ){
+			fprintf( output, ", " );
+		}
+	}
+
+	if ( last < size ){
+		fprintf( output, " ..." );
+	}
+
+	fprintf( output, "]\n" );
+}
+
+
+long int trace_print(const char *trace_filename,
+	const double *initial,
+	long int size,
+	long int context,
+	FILE *output)
+{
+	FILE *fd = fopen( trace_filename, "r" );
+
+	if ( fd == NULL ){
+		return -1;
+	}
+
+	long int count = 0, lost = 0;
+
+	if ( fread( &count, sizeof(long int), 1, fd ) != 1 || fread( &lost, sizeof(long int), 1, fd ) != 1 ){
+
+		fclose( fd );
+
+		return -1;
+	}
+
+	if ( lost > 0 ){
+		fprintf( output, "Warning: %ld events were lost, the replay may not match the run\n", lost );
+	}
+
+	double *array = (double*)malloc( sizeof(double) * ( size > 0 ? size : 1 ) );
+	double *buffer = (double*)malloc( sizeof(double) * ( size > 0 ? size : 1 ) );
+
+	memcpy( array, initial, sizeof(double) * size );
+
+	long int printed = 0;
+
+	trace_event_t event;
+
+	while ( printed < count && fread( &event, sizeof(trace_event_t), 1, fd ) == 1 ){
+
+		printed++;
+
+		if ( event.type == TRACE_EVENT_BEGIN ){
+
+			memcpy( array, initial, sizeof(double) * size );
+
+			fprintf( output, "\n--- Run %ld (%.3f us) ---\n", event.a, 1e6 * event.timestamp );
+
+			continue;
+		}
+
+		long int low = event.a, high = event.c;
+
+		if ( event.type == TRACE_EVENT_SWAP ){
+			low = ( event.a < event.b ) ? event.a : event.b;
+			high = ( event.a < event.b ) ? event.b : event.a;
+		}
+
+		if ( low < 0 || high >= size || low > high ){
+
+			fprintf( output, "Invalid event %ld: [%ld, %ld] outside the vector\n", printed, low, high );
+
+			continue;
+		}
+
+		// The middle of a merge splits [a, c] in [a, b] and [b + 1, c]
+		if ( event.type == TRACE_EVENT_MERGE && ( event.b < event.a || event.b > event.c ) ){
+
+			fprintf( output, "Invalid event %ld: middle %ld outside [%ld, %ld]\n", printed, event.b, event.a, event.c );
+
+			continue;
+		}
+
+		if ( event.type == TRACE_EVENT_SWAP ){
+
+			fprintf( output, "[thread %d, %.3f us] swap %ld <-> %ld\n", event.thread, 1e6 * event.timestamp, event.a, event.b );
+
+			print_trace_window( output, "Before: ", array, size, low, high, 0, context, "1;31" );
+
+			double temp = array[ event.a ];
+			array[ event.a ] = array[ event.b ];
+			array[ event.b ] = temp;
+
+			print_trace_window( output, "After:  ", array, size, low, high, 0, context, "1;32" );
+
+		} else if ( event.type == TRACE_EVENT_MERGE ){
+
+			long int i = event.a, j = event.b + 1, k = event.a;
+
+			while ( i <= event.b && j <= event.c ){
+				buffer[ k++ ] = ( array[ i ] <= array[ j ] ) ? array[ i++ ] : array[ j++ ];
+			}
+
+			while ( i <= event.b ) buffer[ k++ ] = array[ i++ ];
+			while ( j <= event.c ) buffer[ k++ ] = array[ j++ ];
+
+			memcpy( &array[ event.a ], &buffer[ event.a ], sizeof(double) * ( event.c - event.a + 1 ) );
+
+			fprintf( output, "[thread %d, %.3f us] merge [%ld, %ld, %ld]\n",
+				event.thread, 1e6 * event.timestamp, event.a, event.b, event.c );
+
+			print_trace_window( output, "After:  ", array, size, low, high, 1, context, "1;32" );
+		}
+	}
+
+	fclose( fd );
+
+	free( array );
+	free( buffer );
+
+	return printed;
+}
+
+
 #if 0
 void save_vector(DATA_T *data, size_t size, const char *filename){
 	long int i,n_bytes;
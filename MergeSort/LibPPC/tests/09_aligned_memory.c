@@ -0,0 +1,82 @@
+#include <libppc.h>
+
+#include <stdlib.h>
+
+#include <stdio.h>
+
+#include <stdint.h>
+
+#define IS_ALIGNED(pointer, alignment) ( ( (uintptr_t)(pointer) % (alignment) ) == 0 )
+
+int main(){
+
+    /**
+     * Test 1: loaders and generators return 64-byte aligned memory
+     * */
+
+    double *v1 = generate_random_double_vector( 1001, 0, 10 );
+
+    if ( !IS_ALIGNED( v1, ALLOCATION_ALIGNMENT ) )
+        return 1;
+
+    save_double_vector( v1, 1001, "aligned.test.input" );
+
+    double *v2 = load_double_vector( "aligned.test.input", 1001 );
+
+    if ( !IS_ALIGNED( v2, ALLOCATION_ALIGNMENT ) || compare_double_vectors( v1, v2, 1001 ) != 0 )
+        return 2;
+
+    double *m = generate_random_double_matrix( 7, 3 );
+
+    if ( !IS_ALIGNED( m, ALLOCATION_ALIGNMENT ) )
+        return 3;
+
+    free( v1 );
+    free_aligned_memory( v2 );
+    free( m );
+
+    /**
+     * Test 2: big buffers are aligned to huge pages in the huge page modes
+     * */
+
+    if ( parse_huge_page_mode( "thp" ) != HUGE_PAGES_TRANSPARENT || parse_huge_page_mode( "foo" ) != -1 )
+        return 4;
+
+    set_huge_page_mode( HUGE_PAGES_TRANSPARENT );
+
+    double *big = generate_random_double_vector( 1 << 20, 0, 10 );
+
+    if ( big == NULL || !IS_ALIGNED( big, 2 * 1024 * 1024 ) )
+        return 5;
+
+    free_aligned_memory( big );
+
+    // Falls back to transparent huge pages when the hugetlbfs pool is empty
+    set_huge_page_mode( HUGE_PAGES_EXPLICIT );
+
+    big = (double*)allocate_aligned_memory( sizeof(double) * ( 1 << 20 ) );
+
+    if ( big == NULL || !IS_ALIGNED( big, 2 * 1024 * 1024 ) )
+        return 6;
+
+    for ( long int i = 0; i < ( 1 << 20 ); i++ ){
+        big[ i ] = (double)i;
+    }
+
+    free_aligned_memory( big );
+
+    set_huge_page_mode( HUGE_PAGES_NONE );
+
+    /**
+     * Test 3: dTLB counters either work or report -1
+     * */
+
+    start_dtlb_miss_counters();
+
+    long long misses = stop_dtlb_miss_counters();
+
+    if ( misses < -1 )
+        return 7;
+
+    return 0;
+}
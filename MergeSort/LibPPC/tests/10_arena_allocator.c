@@ -0,0 +1,105 @@
+#include <libppc.h>
+
+#include <stdlib.h>
+
+#include <stdio.h>
+
+#include <stdint.h>
+
+#include <omp.h>
+
+int main(){
+
+    /**
+     * Test 1: LIFO allocations on a single arena
+     * */
+
+    arena_t *arena = arena_create( 1024 );
+
+    size_t mark = arena_mark( arena );
+
+    double *a = (double*)arena_alloc( arena, sizeof(double) * 10 );
+    double *b = (double*)arena_alloc( arena, sizeof(double) * 10 );
+
+    if ( (uintptr_t)a % ALLOCATION_ALIGNMENT != 0 || (uintptr_t)b % ALLOCATION_ALIGNMENT != 0 || a == b )
+        return 1;
+
+    arena_reset( arena, mark );
+
+    // Memory is reused after the reset
+    double *c = (double*)arena_alloc( arena, sizeof(double) * 10 );
+
+    if ( c != a )
+        return 2;
+
+    /**
+     * Test 2: a full block chains a new one, which is freed on reset
+     * */
+
+    size_t inner_mark = arena_mark( arena );
+
+    double *big = (double*)arena_alloc( arena, sizeof(double) * 1000 );
+
+    for ( int i = 0; i < 1000; i++ ){
+        big[ i ] = i;
+    }
+
+    arena_reset( arena, inner_mark );
+
+    if ( arena_mark( arena ) != inner_mark )
+        return 3;
+
+    arena_destroy( arena );
+
+    /**
+     * Test 3: thread arenas are independent and counted
+     * */
+
+    set_thread_arena_capacity( 4096 );
+
+    omp_set_num_threads( 4 );
+
+    int errors = 0;
+
+    #pragma omp parallel reduction(+:errors)
+    {
+        arena_t *mine = thread_arena();
+
+        for ( int round = 0; round < 100; round++ ){
+
+            size_t m = arena_mark( mine );
+
+            int *v = (int*)arena_alloc( mine, sizeof(int) * 64 );
+
+            for ( int i = 0; i < 64; i++ ){
+                v[ i ] = omp_get_thread_num();
+            }
+
+            for ( int i = 0; i < 64; i++ ){
+                if ( v[ i ] != omp_get_thread_num() )
+                    errors++;
+            }
+
+            arena_reset( mine, m );
+        }
+    }
+
+    if ( errors != 0 )
+        return 4;
+
+    arena_statistics_t statistics;
+
+    get_thread_arena_statistics( &statistics );
+
+    if ( statistics.allocations != 100L * statistics.arenas || statistics.peak_bytes != 256 || statistics.overflow_blocks != 0 )
+        return 5;
+
+    destroy_thread_arenas();
+
+    get_thread_arena_statistics( &statistics );
+
+    if ( statistics.arenas != 0 )
+        return 6;
+
+    return 0;
+}
@@ -0,0 +1,350 @@
+#ifndef __MERGESORT_H__
+
+#define __MERGESORT_H__
+
+#include <stddef.h>
+#include <libppc.h>
+
+/**
+	\brief Funde array[left..mid] e array[mid+1..right], já ordenados
+*/
+void merge(double *array, long int left, long int mid, long int right);
+
+/**
+	\brief Merge sort recursivo de array[left..right]
+*/
+void MergeSort_serial(double *array, long int left, long int right);
+
+/**
+	\brief Merge sort com as duas metades ordenadas em paralelo até depth níveis
+*/
+void MergeSort_parallel(double *array, long int left, long int right, int depth);
+
+
+/**
+	\brief Árvore de perdedores (torneio) para fusões k-way
+
+	Cada fonte tem uma chave atual em keys[]; nodes[0] é a fonte vencedora
+	(menor chave) e nodes[1..k-1] guardam o perdedor de cada jogo. Depois de
+	consumir a vencedora, basta atualizar sua chave (ou marcá-la em exhausted)
+	e chamar loser_tree_replay: log2(k) comparações, sem trocas como no heap.
+*/
+typedef struct {
+	int k;
+	int *nodes;
+	double *keys;
+	int *exhausted;
+} loser_tree_t;
+
+/**
+	\brief Aloca a árvore na arena; keys e exhausted devem ser preenchidos antes de loser_tree_build
+*/
+void loser_tree_init(loser_tree_t *tree, int k, arena_t *arena);
+
+/**
+	\brief Joga o torneio completo a partir das chaves iniciais
+*/
+void loser_tree_build(loser_tree_t *tree, arena_t *arena);
+
+/**
+	\brief Rejoga o caminho da fonte source depois que sua chave mudou
+*/
+void loser_tree_replay(loser_tree_t *tree, int source);
+
+#define loser_tree_winner(tree) ((tree)->nodes[0])
+
+// Maior k aceito por MergeSort_multiway
+#define MULTIWAY_MAX_FAN_IN 64
+
+/**
+	\brief Merge sort multiway: blocos do tamanho da cache + fusões k-way
+
+	Ordena blocos pequenos em paralelo e depois funde k runs por vez com uma
+	árvore de perdedores, fazendo log_k(N) passadas sobre a memória em vez de
+	log2(N). As últimas passadas são divididas por divisores amostrados para
+	ocupar todas as threads.
+
+	\return o número de passadas sobre o vetor (incluindo a dos blocos)
+*/
+int MergeSort_multiway(double *array, long int size, int k);
+
+
+/**
+	\brief Radix sort LSD paralelo de doubles
+
+	Cada double é mapeado para uma chave sem sinal que preserva a ordem
+	(negativos antes de positivos, -0.0 antes de +0.0, NaN sempre no fim, na
+	ordem de entrada). Cada passada de 8 bits usa histogramas por thread,
+	soma de prefixos e escrita por buffers de write-combining; passadas em
+	que todos os elementos têm o mesmo dígito são puladas. Estável.
+*/
+void RadixSort_double(double *array, long int size);
+
+/**
+	\brief Radix sort LSD paralelo de ints (4 passadas de 8 bits)
+*/
+void RadixSort_int(int *array, long int size);
+
+
+// Limite de baldes de SampleSort_parallel (o balde de cada elemento é um unsigned short)
+#define SAMPLE_SORT_MAX_BUCKETS 4096
+
+/**
+	\brief Estatísticas de uma execução de SampleSort_parallel
+*/
+typedef struct {
+
+	int buckets;
+
+	long int smallest_bucket;
+	long int largest_bucket;
+
+	// Maior balde dividido pelo tamanho médio (1.0 = balanceado)
+	double imbalance;
+
+} sample_sort_statistics_t;
+
+/**
+	\brief Sample sort paralelo: um balde por thread
+
+	Escolhe buckets - 1 divisores entre buckets * oversampling amostras,
+	distribui os elementos nos baldes numa única passada paralela (contagem
+	por thread + soma de prefixos) e ordena cada balde de forma independente.
+	Mais oversampling deixa os baldes mais parecidos em dados assimétricos.
+
+	\param statistics preenchido com o desbalanceamento dos baldes, se não for NULL
+*/
+void SampleSort_parallel(double *array, long int size, int oversampling,
+	sample_sort_statistics_t *statistics);
+
+
+/**
+	\brief Estatísticas de uma execução de MergeSort_natural
+*/
+typedef struct {
+
+	// Runs depois da detecção e da extensão por inserção
+	long int runs;
+
+	// Níveis de fusões de pares de runs (log2 de runs)
+	int merge_levels;
+
+} natural_sort_statistics_t;
+
+/**
+	\brief Merge sort natural (estilo Timsort) para entradas parcialmente ordenadas
+
+	Detecta runs crescentes e estritamente decrescentes (estes são invertidos),
+	estende runs curtos com inserção binária e funde runs vizinhos no lugar,
+	nível a nível, com galope (busca exponencial) quando um lado vence várias
+	vezes seguidas. Runs já em ordem entre si não são fundidos, então uma
+	entrada ordenada ou invertida custa O(N). A detecção é dividida entre as
+	threads e as fusões de um mesmo nível rodam em paralelo.
+
+	\param statistics preenchido se não for NULL
+*/
+void MergeSort_natural(double *array, long int size, natural_sort_statistics_t *statistics);
+
+
+/**
+	\brief Registro (chave, payload) do layout AoS; o payload costuma ser um índice
+*/
+typedef struct {
+	double key;
+	long int value;
+} key_value_t;
+
+/**
+	\brief Ordena pares (chave, payload) pela chave, de forma estável (AoS)
+
+	Merge sort de baixo para cima: blocos de 32 por inserção e fusões em
+	buffers alternados, movendo os registros inteiros (16 bytes) em vez de
+	ponteiros para eles. A versão paralela divide os blocos e as fusões de
+	cada nível entre as threads; as últimas fusões são cortadas em trechos
+	independentes pelo merge path.
+*/
+void KeyValueSort_serial(key_value_t *pairs, long int size);
+void KeyValueSort_parallel(key_value_t *pairs, long int size);
+
+/**
+	\brief Ordena keys de forma estável levando values junto (SoA)
+*/
+void KeyValueSort_soa_serial(double *keys, long int *values, long int size);
+void KeyValueSort_soa_parallel(double *keys, long int *values, long int size);
+
+/**
+	\brief Argsort: indices recebe a permutação estável que ordena keys
+
+	keys não é modificado; a permutação pode reordenar vetores companheiros
+	com permute_double_vector.
+*/
+void ArgSort_serial(const double *keys, long int *indices, long int size);
+void ArgSort_parallel(const double *keys, long int *indices, long int size);
+
+/**
+	\brief destination[i] = source[indices[i]], em paralelo
+*/
+void permute_double_vector(const double *source, const long int *indices, double *destination, long int size);
+
+
+/**
+	\brief Seleção (nth_element) no lugar por Floyd-Rivest
+
+	Ao final array[k] é o elemento que estaria na posição k do vetor
+	ordenado, os anteriores são <= a ele e os posteriores >=. O(N) em média.
+
+	\return array[k]
+*/
+double Select_serial(double *array, long int size, long int k);
+
+/**
+	\brief Seleção paralela do k-ésimo menor elemento (k a partir de 0), sem modificar array
+
+	Uma amostra de N^(2/3) elementos escolhe dois limites em volta da posição
+	de k; uma passada paralela conta os elementos abaixo do limite inferior e
+	junta os que ficam entre os limites, e a seleção final é feita só nesses
+	candidatos. Se a amostra errar, cai na seleção serial de uma cópia.
+*/
+double Select_parallel(const double *array, long int size, long int k);
+
+/**
+	\brief Os k menores elementos de array, em ordem crescente, em output
+
+	Cada thread mantém um max-heap com os k menores do seu trecho; os heaps
+	são juntados no fim e reduzidos com Select_serial. O(N log k).
+*/
+void TopK_parallel(const double *array, long int size, long int k, double *output);
+
+
+/**
+	\brief Aplica um lote de atualizações a um vetor já ordenado e o reordena
+
+	array[indices[b]] passa a valer values[b] (com índices repetidos, vale
+	o último do lote) e array volta a ficar em ordem crescente, sem ordenar
+	tudo de novo: o lote é ordenado, O(k log k), e uma única fusão paralela
+	junta os elementos não atualizados, que continuam em ordem, com o lote
+	ordenado, O(N).
+
+	\param array vetor em ordem crescente
+	\param indices posições, no vetor ordenado, dos elementos atualizados
+	\param values novos valores
+	\param count tamanho do lote
+
+	\return 0 em caso de sucesso, -1 se algum índice está fora do vetor
+	(nesse caso array não é alterado)
+*/
+int MergeSort_update(double *array, long int size, const long int *indices, const double *values, long int count);
+
+
+// Ordens aceitas por PointSort_parallel
+enum point_order_enum {
+	POINT_ORDER_X = 0,
+	POINT_ORDER_XY,
+	POINT_ORDER_MORTON,
+	POINT_ORDER_HILBERT
+};
+
+/**
+	\brief Ordena pontos por x, por (x, y) ou ao longo de uma curva (Morton/Hilbert)
+
+	Os pontos são ordenados como pares (chave, índice) por KeyValueSort_parallel
+	e movidos uma única vez no final. (x, y) é feito por duas ordenações
+	estáveis, y e depois x. Nas curvas, as coordenadas são levadas a uma grade
+	de 2^26 x 2^26 células da caixa envolvente e a chave de 52 bits cabe
+	exatamente num double; pontos vizinhos na ordem ficam próximos no plano.
+
+	\param order um valor de point_order_enum
+*/
+void PointSort_parallel(point2D_t *points, long int size, int order);
+
+/**
+	\brief Distância média entre pontos consecutivos (mede a localidade de uma ordem)
+*/
+double mean_point_step(const point2D_t *points, long int size);
+
+
+// Conjuntos de instruções aceitos por MergeSort_network
+enum simd_isa_enum {
+	SIMD_AUTO = -1,
+	SIMD_SCALAR = 0,
+	SIMD_AVX2,
+	SIMD_AVX512
+};
+
+/**
+	\brief Melhor conjunto de instruções suportado pela CPU em que o programa roda
+*/
+int best_simd_isa(void);
+
+/**
+	\brief Merge sort com redes de ordenação SIMD no caso base
+
+	Blocos de 16 (AVX2) ou 64 (AVX-512) doubles são ordenados dentro dos
+	registradores por uma rede de ordenação entre registradores, uma
+	transposição e redes de fusão bitônica, sem nenhum desvio dependente dos
+	dados. Os níveis de cima fundem pares de runs com uma rede bitônica 4+4
+	(ou 8+8) por passo; sem SIMD, usa ordenação por inserção e uma fusão
+	escalar sem desvios (cmov). Os blocos e as fusões de um mesmo nível são
+	divididos entre as threads.
+
+	\param isa um valor de simd_isa_enum; SIMD_AUTO escolhe best_simd_isa()
+
+	\return o conjunto de instruções usado
+*/
+int MergeSort_network(double *array, long int size, int isa);
+
+
+/**
+	\brief Estatísticas de uma execução de MergeSort_external
+*/
+typedef struct {
+
+	long int elements;
+
+	// Runs ordenados em memória e passadas de fusão k-way sobre o disco
+	long int runs;
+	int merge_passes;
+	int fan_in;
+
+	double run_time;
+	double merge_time;
+
+} external_sort_statistics_t;
+
+/**
+	\brief Ordena um arquivo de doubles maior que a memória (ordenação externa)
+
+	Lê o arquivo em blocos de até memory_budget / (1 + T) bytes, com T o
+	número de threads (cada thread tem uma arena do tamanho do bloco para os
+	temporários de merge()), ordena cada bloco com MergeSort_parallel, grava
+	os runs em arquivos temporários (já removidos do diretório, somem ao
+	fechar) e faz fusões k-way com buffers sequenciais grandes. Nenhuma fase
+	usa mais que memory_budget bytes de buffers. Um arquivo vazio gera uma
+	saída vazia.
+
+	\param input_filename arquivo de entrada (doubles em binário)
+	\param output_filename arquivo ordenado de saída
+	\param memory_budget limite de memória em bytes
+	\param temporary_directory diretório dos runs (NULL usa /tmp)
+	\param statistics preenchido se não for NULL
+
+	\return 0 em caso de sucesso
+*/
+int MergeSort_external(const char *input_filename,
+	const char *output_filename,
+	size_t memory_budget,
+	const char *temporary_directory,
+	external_sort_statistics_t *statistics);
+
+/**
+	\brief Percorre um arquivo de doubles em blocos, sem carregá-lo inteiro
+
+	\param checksum soma dos padrões de bits dos elementos (independe da ordem),
+	usada para conferir que a saída é uma permutação da entrada
+	\param is_sorted recebe 1 se o arquivo está em ordem crescente
+
+	\return o número de elementos, -1 se o arquivo não pode ser aberto
+*/
+long int scan_double_vector_file(const char *filename, unsigned long *checksum, int *is_sorted);
+
+#endif
@@ -0,0 +1,324 @@
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <malloc.h>
+#include <sys/stat.h>
+#include <libppc.h>
+#include <omp.h>
+
+#include "mergesort.h"
+
+// Menor buffer de leitura por run durante a fusão: abaixo disso as leituras
+// deixam de ser sequenciais o bastante e o fan-in é reduzido.
+#define MIN_MERGE_BUFFER (256L * 1024)
+
+// Tamanho dos blocos lidos na verificação do arquivo de saída
+#define SCAN_BUFFER_ELEMENTS 65536
+
+typedef struct {
+    FILE *file;
+    long int elements;
+} run_t;
+
+// Leitor bufferizado de um run durante a fusão k-way
+typedef struct {
+    FILE *file;
+    double *buffer;
+    long int capacity;
+    long int count;
+    long int position;
+    long int remaining;
+} run_reader_t;
+
+
+static FILE *create_temporary_run(const char *directory) {
+    char path[4096];
+    snprintf(path, sizeof(path), "%s/mergesort_run_XXXXXX", directory);
+    int fd = mkstemp(path);
+    if (fd < 0) {
+        perror("Error: could not create a temporary run");
+        return NULL;
+    }
+    // O nome é removido já na criação: o espaço em disco é liberado quando
+    // o arquivo é fechado, mesmo que o programa termine no meio da ordenação.
+    unlink(path);
+    FILE *file = fdopen(fd, "w+b");
+    // Leituras e escritas já são feitas em blocos grandes; o buffer do stdio
+    // só ocuparia mais memória por run
+    if (file != NULL)
+        setvbuf(file, NULL, _IONBF, 0);
+    return file;
+}
+
+
+static int refill_reader(run_reader_t *reader) {
+    long int n = reader->remaining < reader->capacity ? reader->remaining : reader->capacity;
+    reader->count = (long int)fread(reader->buffer, sizeof(double), n, reader->file);
+    reader->position = 0;
+    reader->remaining -= reader->count;
+    return reader->count > 0;
+}
+
+
+static int write_elements(FILE *file, const double *data, long int count) {
+    if ((long int)fwrite(data, sizeof(double), count, file) != count) {
+        perror("Error: could not write the sorted data");
+        return -1;
+    }
+    return 0;
+}
+
+
+// Funde k runs em output com uma árvore de perdedores. Os buffers saem de
+// workspace (workspace_elements doubles), o mesmo em todas as fusões.
+static int merge_runs(run_t *runs, int k, FILE *output, double *workspace, long int workspace_elements) {
+    if (k < 1)
+        return 0;
+    // k buffers de leitura + 1 de escrita, todos do mesmo tamanho
+    long int buffer_elements = workspace_elements / (k + 1);
+    if (buffer_elements < 1) {
+        fprintf(stderr, "Error: memory budget is too small to merge %d runs\n", k);
+        return -1;
+    }
+
+    run_reader_t *readers = (run_reader_t*)malloc(sizeof(run_reader_t) * k);
+    double *output_buffer = &workspace[k * buffer_elements];
+    arena_t *arena = thread_arena();
+    size_t mark = arena_mark(arena);
+    loser_tree_t tree;
+    loser_tree_init(&tree, k, arena);
+    int status = 0;
+
+    for (int r = 0; r < k; r++) {
+        rewind(runs[r].file);
+        readers[r].file = runs[r].file;
+        readers[r].buffer = &workspace[r * buffer_elements];
+        readers[r].capacity = buffer_elements;
+        readers[r].remaining = runs[r].elements;
+        if (refill_reader(&readers[r]))
+            tree.keys[r] = readers[r].buffer[0];
+        else
+            tree.exhausted[r] = 1;
+    }
+    loser_tree_build(&tree, arena);
+
+    long int output_count = 0;
+    while (!tree.exhausted[loser_tree_winner(&tree)]) {
+        int r = loser_tree_winner(&tree);
+        run_reader_t *reader = &readers[r];
+        output_buffer[output_count++] = tree.keys[r];
+        if (output_count == buffer_elements) {
+            if (write_elements(output, output_buffer, output_count) != 0) {
+                status = -1;
+                break;
+            }
+            output_count = 0;
+        }
+        // Run esgotado perde todos os jogos a partir daqui
+        if (++reader->position < reader->count || refill_reader(reader))
+            tree.keys[r] = reader->buffer[reader->position];
+        else
+            tree.exhausted[r] = 1;
+        loser_tree_replay(&tree, r);
+    }
+    if (status == 0)
+        status = write_elements(output, output_buffer, output_count);
+
+    free(readers);
+    arena_reset(arena, mark);
+    return status;
+}
+
+
+int MergeSort_external(const char *input_filename,
+    const char *output_filename,
+    size_t memory_budget,
+    const char *temporary_directory,
+    external_sort_statistics_t *statistics) {
+
+    external_sort_statistics_t local_statistics;
+    if (statistics == NULL)
+        statistics = &local_statistics;
+    memset(statistics, 0, sizeof(external_sort_statistics_t));
+    if (temporary_directory == NULL)
+        temporary_directory = "/tmp";
+
+    FILE *input = fopen(input_filename, "rb");
+    if (input == NULL) {
+        fprintf(stderr, "Error: could not open %s\n", input_filename);
+        return -1;
+    }
+    struct stat input_stat;
+    if (fstat(fileno(input), &input_stat) != 0) {
+        fprintf(stderr, "Error: could not read the size of %s\n", input_filename);
+        fclose(input);
+        return -1;
+    }
+    long int elements = input_stat.st_size / sizeof(double);
+    statistics->elements = elements;
+    posix_fadvise(fileno(input), 0, 0, POSIX_FADV_SEQUENTIAL);
+    setvbuf(input, NULL, _IONBF, 0);
+
+    if (elements == 0) {
+        fclose(input);
+        FILE *output = fopen(output_filename, "wb");
+        if (output == NULL) {
+            fprintf(stderr, "Error: could not create %s\n", output_filename);
+            return -1;
+        }
+        fclose(output);
+        return 0;
+    }
+
+    // O bloco e a arena de cada thread (os temporários de merge(), até um
+    // bloco inteiro) dividem o orçamento: bloco + T arenas <= memory_budget
+    int threads = omp_get_max_threads();
+    size_t arena_overhead = (size_t)threads * 2 * ALLOCATION_ALIGNMENT;
+    long int run_elements = memory_budget > arena_overhead ?
+        (memory_budget - arena_overhead) / ((1 + threads) * sizeof(double)) : 0;
+    if (run_elements < 1) {
+        fprintf(stderr, "Error: memory budget of %zu bytes is too small\n", memory_budget);
+        fclose(input);
+        return -1;
+    }
+    if (run_elements > elements)
+        run_elements = elements;
+
+    int depth = 0;
+    while ((1 << depth) < threads)
+        depth++;
+
+    // Fase 1: runs ordenados em memória
+    double start = omp_get_wtime();
+    long int number_of_runs = (elements + run_elements - 1) / run_elements;
+    run_t *runs = (run_t*)malloc(sizeof(run_t) * number_of_runs);
+    if (runs == NULL) {
+        fclose(input);
+        return -1;
+    }
+    // Uma única área de memory_budget bytes: o bloco da fase 1 é o começo
+    // dela e os buffers das fusões a dividem inteira. Alocações separadas
+    // a cada fusão fragmentam o heap e a memória residente cresce além do
+    // orçamento.
+    long int workspace_elements = memory_budget / sizeof(double);
+    double *workspace = (double*)allocate_aligned_memory(sizeof(double) * workspace_elements);
+    if (workspace == NULL) {
+        free(runs);
+        fclose(input);
+        return -1;
+    }
+    double *block = workspace;
+    set_thread_arena_capacity(sizeof(double) * run_elements + 2 * ALLOCATION_ALIGNMENT);
+
+    int status = 0;
+    for (long int r = 0; r < number_of_runs && status == 0; r++) {
+        long int n = (long int)fread(block, sizeof(double), run_elements, input);
+        runs[r].elements = n;
+        runs[r].file = create_temporary_run(temporary_directory);
+        if (runs[r].file == NULL) {
+            number_of_runs = r;
+            status = -1;
+            break;
+        }
+        MergeSort_parallel(block, 0, n - 1, depth);
+        status = write_elements(runs[r].file, block, n);
+        // Disco cheio, por exemplo: só os runs até r têm arquivo
+        if (status != 0)
+            number_of_runs = r + 1;
+    }
+    fclose(input);
+    // Os temporários das arenas não contam mais no orçamento da fusão. Uma
+    // arena que veio do heap (e não de um mmap próprio) continua residente
+    // depois do free: malloc_trim devolve as páginas antes de a fusão tocar
+    // o resto de workspace.
+    destroy_thread_arenas();
+    malloc_trim(0);
+    statistics->runs = number_of_runs;
+    statistics->run_time = omp_get_wtime() - start;
+
+    // Fase 2: fusões k-way; com runs demais para o orçamento, são feitas
+    // várias passadas, cada uma fundindo grupos de fan_in runs.
+    start = omp_get_wtime();
+    int fan_in = memory_budget / MIN_MERGE_BUFFER - 1;
+    if (fan_in < 2)
+        fan_in = 2;
+    statistics->fan_in = fan_in;
+    // Na fusão as arenas só guardam a árvore de perdedores
+    set_thread_arena_capacity(sizeof(double) * 4 * (fan_in + 1) + 8 * ALLOCATION_ALIGNMENT);
+
+    while (status == 0 && number_of_runs > fan_in) {
+        long int merged_runs = 0, first;
+        for (first = 0; first < number_of_runs && status == 0; first += fan_in) {
+            int k = (number_of_runs - first) < fan_in ? (int)(number_of_runs - first) : fan_in;
+            run_t merged = { create_temporary_run(temporary_directory), 0 };
+            if (merged.file == NULL) {
+                status = -1;
+                break;
+            }
+            for (int r = 0; r < k; r++)
+                merged.elements += runs[first + r].elements;
+            status = merge_runs(&runs[first], k, merged.file, workspace, workspace_elements);
+            for (int r = 0; r < k; r++)
+                fclose(runs[first + r].file);
+            runs[merged_runs++] = merged;
+        }
+        // Depois de um erro, os runs a partir de first não foram fundidos
+        // nem fechados; fechá-los libera o espaço dos temporários
+        for (long int r = first; r < number_of_runs; r++)
+            fclose(runs[r].file);
+        number_of_runs = merged_runs;
+        statistics->merge_passes++;
+    }
+
+    if (status == 0) {
+        FILE *output = fopen(output_filename, "wb");
+        if (output == NULL) {
+            fprintf(stderr, "Error: could not create %s\n", output_filename);
+            status = -1;
+        } else {
+            setvbuf(output, NULL, _IONBF, 0);
+            status = merge_runs(runs, (int)number_of_runs, output, workspace, workspace_elements);
+            fclose(output);
+            statistics->merge_passes++;
+        }
+    }
+    for (long int r = 0; r < number_of_runs; r++)
+        fclose(runs[r].file);
+    free(runs);
+    free_aligned_memory(workspace);
+    statistics->merge_time = omp_get_wtime() - start;
+    return status;
+}
+
+
+long int scan_double_vector_file(const char *filename, unsigned long *checksum, int *is_sorted) {
+    FILE *file = fopen(filename, "rb");
+    if (file == NULL)
+        return -1;
+
+    double *buffer = (double*)malloc(sizeof(double) * SCAN_BUFFER_ELEMENTS);
+    long int elements = 0;
+    size_t n;
+    double previous = 0.0;
+    *checksum = 0;
+    *is_sorted = 1;
+
+    while ((n = fread(buffer, sizeof(double), SCAN_BUFFER_ELEMENTS, file)) > 0) {
+        for (size_t i = 0; i < n; i++) {
+            unsigned long bits;
+            memcpy(&bits, &buffer[i], sizeof(bits));
+            // Soma dos padrões de bits: não depende da ordem dos elementos
+            *checksum += bits;
+            if (elements + (long int)i > 0 && buffer[i] < previous)
+                *is_sorted = 0;
+            previous = buffer[i];
+        }
+        elements += n;
+    }
+
+    free(buffer);
+    fclose(file);
+    return elements;
+}
@@ -0,0 +1,113 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <libppc.h>
+#include <omp.h>
+
+#include "mergesort.h"
+
+
+// Posição em array do r-ésimo elemento que não foi atualizado. removed
+// está em ordem estritamente crescente, então removed[m] - m (quantos
+// elementos mantidos há antes de removed[m]) é não decrescente e a busca
+// binária conta os removidos que vêm antes do r-ésimo mantido.
+static long int kept_position(const long int *removed, long int count, long int r) {
+    long int low = 0, high = count;
+    while (low < high) {
+        long int m = low + (high - low) / 2;
+        if (removed[m] - m <= r)
+            low = m + 1;
+        else
+            high = m;
+    }
+    return r + low;
+}
+
+
+// Quantos dos k primeiros elementos da fusão vêm dos mantidos (merge path);
+// empates ficam com os mantidos
+static long int co_rank(const double *array, const long int *removed, long int count, long int kept,
+                        const double *batch, long int k) {
+    long int low = k > count ? k - count : 0, high = k < kept ? k : kept;
+    while (low < high) {
+        long int i = low + (high - low) / 2;
+        if (batch[k - i - 1] >= array[kept_position(removed, count, i)])
+            low = i + 1;
+        else
+            high = i;
+    }
+    return low;
+}
+
+
+int MergeSort_update(double *array, long int size, const long int *indices, const double *values, long int count) {
+    for (long int b = 0; b < count; b++) {
+        if (indices[b] < 0 || indices[b] >= size)
+            return -1;
+    }
+    if (count <= 0)
+        return 0;
+
+    // 1. Lote em ordem de índice, estável: com índices repetidos vale o
+    //    último valor do lote, como se as atualizações fossem aplicadas em
+    //    sequência. O(k log k).
+    key_value_t *pairs = (key_value_t*)malloc(sizeof(key_value_t) * count);
+    for (long int b = 0; b < count; b++) {
+        pairs[b].key = (double)indices[b];
+        pairs[b].value = b;
+    }
+    KeyValueSort_serial(pairs, count);
+    long int *removed = (long int*)malloc(sizeof(long int) * count);
+    double *batch = (double*)malloc(sizeof(double) * count);
+    long int updated = 0;
+    for (long int b = 0; b < count; b++) {
+        if (b + 1 < count && pairs[b + 1].key == pairs[b].key)
+            continue;
+        removed[updated] = (long int)pairs[b].key;
+        batch[updated++] = values[pairs[b].value];
+    }
+    free(pairs);
+    MergeSort_serial(batch, 0, updated - 1);
+
+    // 2. Uma fusão paralela dos elementos mantidos (o vetor sem as posições
+    //    atualizadas, ainda em ordem) com o lote ordenado. Cada thread
+    //    produz um trecho fixo da saída, achado pelo merge path, e depois de
+    //    uma barreira copia o seu trecho de volta. O(N) no total.
+    long int kept = size - updated;
+    double *output = (double*)allocate_aligned_memory(sizeof(double) * size);
+
+    #pragma omp parallel
+    {
+        int t = omp_get_thread_num();
+        int threads = omp_get_num_threads();
+        long int first = size * t / threads, last = size * (t + 1) / threads;
+        long int i = co_rank(array, removed, updated, kept, batch, first);
+        long int i_end = co_rank(array, removed, updated, kept, batch, last);
+        long int j = first - i, j_end = last - i_end;
+
+        // Percorre os mantidos pulando as posições removidas
+        long int position = kept_position(removed, updated, i);
+        long int next = position - i;
+        for (long int k = first; k < last; k++) {
+            if (j >= j_end || (i < i_end && array[position] <= batch[j])) {
+                output[k] = array[position];
+                i++;
+                position++;
+                while (next < updated && removed[next] == position) {
+                    next++;
+                    position++;
+                }
+            } else {
+                output[k] = batch[j++];
+            }
+        }
+
+        #pragma omp barrier
+        memcpy(&array[first], &output[first], sizeof(double) * (last - first));
+    }
+
+    free_aligned_memory(output);
+    free(removed);
+    free(batch);
+    return 0;
+}
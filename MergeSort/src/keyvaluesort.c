@@ -0,0 +1,219 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <libppc.h>
+#include <omp.h>
+
+#include "mergesort.h"
+
+// Blocos iniciais ordenados por inserção antes das fusões
+#define KV_INSERTION_BLOCK 32
+
+
+// Vetor de pares em um dos dois layouts: pairs (AoS) ou keys + values (SoA).
+// Chaves e payloads andam juntos em todas as cópias; nunca há ponteiros
+// para os registros.
+typedef struct {
+    key_value_t *pairs;
+    double *keys;
+    long int *values;
+} kv_array_t;
+
+
+static inline double key_at(const kv_array_t *array, long int i) {
+    return array->pairs != NULL ? array->pairs[i].key : array->keys[i];
+}
+
+
+static void insertion_sort_aos(key_value_t *pairs, long int left, long int right) {
+    for (long int i = left + 1; i < right; i++) {
+        key_value_t pair = pairs[i];
+        long int j = i - 1;
+        while (j >= left && pairs[j].key > pair.key) {
+            pairs[j + 1] = pairs[j];
+            j--;
+        }
+        pairs[j + 1] = pair;
+    }
+}
+
+
+static void insertion_sort_soa(double *keys, long int *values, long int left, long int right) {
+    for (long int i = left + 1; i < right; i++) {
+        double key = keys[i];
+        long int value = values[i];
+        long int j = i - 1;
+        while (j >= left && keys[j] > key) {
+            keys[j + 1] = keys[j];
+            values[j + 1] = values[j];
+            j--;
+        }
+        keys[j + 1] = key;
+        values[j + 1] = value;
+    }
+}
+
+
+// Fusão estável de source[a..a+na) e source[b..b+nb) em destination[k..)
+static void merge_pairs(const kv_array_t *source, long int a, long int na, long int b, long int nb,
+                        kv_array_t *destination, long int k) {
+    long int end_a = a + na, end_b = b + nb;
+    if (source->pairs != NULL) {
+        const key_value_t *in = source->pairs;
+        key_value_t *out = destination->pairs;
+        while (a < end_a && b < end_b)
+            out[k++] = (in[a].key <= in[b].key) ? in[a++] : in[b++];
+        while (a < end_a) out[k++] = in[a++];
+        while (b < end_b) out[k++] = in[b++];
+    } else {
+        const double *keys = source->keys;
+        const long int *values = source->values;
+        while (a < end_a && b < end_b) {
+            long int from = (keys[a] <= keys[b]) ? a++ : b++;
+            destination->keys[k] = keys[from];
+            destination->values[k++] = values[from];
+        }
+        for (; a < end_a; a++, k++) {
+            destination->keys[k] = keys[a];
+            destination->values[k] = values[a];
+        }
+        for (; b < end_b; b++, k++) {
+            destination->keys[k] = keys[b];
+            destination->values[k] = values[b];
+        }
+    }
+}
+
+
+// Quantos dos k primeiros elementos da fusão de [a..a+na) e [b..b+nb) vêm
+// do primeiro run (merge path). Com esse corte, trechos diferentes de uma
+// mesma fusão podem ser feitos por threads diferentes.
+static long int co_rank(const kv_array_t *array, long int k, long int a, long int na, long int b, long int nb) {
+    long int low = k > nb ? k - nb : 0, high = k < na ? k : na;
+    while (low < high) {
+        long int i = low + (high - low) / 2;
+        // Empates vão para o primeiro run, que precisa ceder mais elementos
+        if (key_at(array, b + k - i - 1) >= key_at(array, a + i))
+            low = i + 1;
+        else
+            high = i;
+    }
+    return low;
+}
+
+
+static void sort_pairs(kv_array_t *array, long int size, int parallel) {
+    if (size < 2)
+        return;
+    int threads = parallel ? omp_get_max_threads() : 1;
+
+    long int number_of_blocks = (size + KV_INSERTION_BLOCK - 1) / KV_INSERTION_BLOCK;
+    #pragma omp parallel for schedule(static) if(parallel)
+    for (long int b = 0; b < number_of_blocks; b++) {
+        long int left = b * KV_INSERTION_BLOCK;
+        long int right = (left + KV_INSERTION_BLOCK < size) ? left + KV_INSERTION_BLOCK : size;
+        if (array->pairs != NULL)
+            insertion_sort_aos(array->pairs, left, right);
+        else
+            insertion_sort_soa(array->keys, array->values, left, right);
+    }
+
+    kv_array_t buffer = { NULL, NULL, NULL };
+    if (array->pairs != NULL) {
+        buffer.pairs = (key_value_t*)allocate_aligned_memory(sizeof(key_value_t) * size);
+    } else {
+        buffer.keys = (double*)allocate_aligned_memory(sizeof(double) * size);
+        buffer.values = (long int*)allocate_aligned_memory(sizeof(long int) * size);
+    }
+    kv_array_t *source = array, *destination = &buffer;
+
+    for (long int width = KV_INSERTION_BLOCK; width < size; width *= 2) {
+        long int pairs_of_runs = (size + 2 * width - 1) / (2 * width);
+        // Nos últimos níveis há menos fusões que threads: cada fusão é
+        // dividida em parts trechos pelo merge path
+        long int parts = (pairs_of_runs < threads) ? (threads + pairs_of_runs - 1) / pairs_of_runs : 1;
+
+        #pragma omp parallel for schedule(dynamic) if(parallel)
+        for (long int task = 0; task < pairs_of_runs * parts; task++) {
+            long int left = (task / parts) * 2 * width, part = task % parts;
+            long int na = (left + width < size) ? width : size - left;
+            long int nb = (left + 2 * width < size) ? width : size - left - na;
+            long int first = (na + nb) * part / parts, last = (na + nb) * (part + 1) / parts;
+            long int i0 = co_rank(source, first, left, na, left + na, nb);
+            long int i1 = co_rank(source, last, left, na, left + na, nb);
+            merge_pairs(source, left + i0, i1 - i0, left + na + first - i0, (last - i1) - (first - i0),
+                        destination, left + first);
+        }
+
+        kv_array_t *swap = source;
+        source = destination;
+        destination = swap;
+    }
+
+    if (source != array) {
+        if (array->pairs != NULL) {
+            memcpy(array->pairs, source->pairs, sizeof(key_value_t) * size);
+        } else {
+            memcpy(array->keys, source->keys, sizeof(double) * size);
+            memcpy(array->values, source->values, sizeof(long int) * size);
+        }
+    }
+    free_aligned_memory(buffer.pairs);
+    free_aligned_memory(buffer.keys);
+    free_aligned_memory(buffer.values);
+}
+
+
+void KeyValueSort_serial(key_value_t *pairs, long int size) {
+    kv_array_t array = { pairs, NULL, NULL };
+    sort_pairs(&array, size, 0);
+}
+
+
+void KeyValueSort_parallel(key_value_t *pairs, long int size) {
+    kv_array_t array = { pairs, NULL, NULL };
+    sort_pairs(&array, size, 1);
+}
+
+
+void KeyValueSort_soa_serial(double *keys, long int *values, long int size) {
+    kv_array_t array = { NULL, keys, values };
+    sort_pairs(&array, size, 0);
+}
+
+
+void KeyValueSort_soa_parallel(double *keys, long int *values, long int size) {
+    kv_array_t array = { NULL, keys, values };
+    sort_pairs(&array, size, 1);
+}
+
+
+// Argsort = ordenação SoA de uma cópia das chaves com os índices como payload
+static void argsort(const double *keys, long int *indices, long int size, int parallel) {
+    double *copy = (double*)allocate_aligned_memory(sizeof(double) * (size > 0 ? size : 1));
+    #pragma omp parallel for schedule(static) if(parallel)
+    for (long int i = 0; i < size; i++) {
+        copy[i] = keys[i];
+        indices[i] = i;
+    }
+    kv_array_t array = { NULL, copy, indices };
+    sort_pairs(&array, size, parallel);
+    free_aligned_memory(copy);
+}
+
+
+void ArgSort_serial(const double *keys, long int *indices, long int size) {
+    argsort(keys, indices, size, 0);
+}
+
+
+void ArgSort_parallel(const double *keys, long int *indices, long int size) {
+    argsort(keys, indices, size, 1);
+}
+
+
+void permute_double_vector(const double *source, const long int *indices, double *destination, long int size) {
+    #pragma omp parallel for schedule(static)
+    for (long int i = 0; i < size; i++)
+        destination[i] = source[indices[i]];
+}
@@ -6,20 +6,98 @@
 #include <omp.h>
 #include <string.h>
 
+#include "mergesort.h"
+
 #define SIZE 400000
 
+// Compile com make clean all CFLAGS=-D__TRACE__ para gravar as fusões do
+// fluxo padrão em trace.dat; LibPPC/examples/tracedump mostra o trace
+#define TRACE_THREADS 8
+#define TRACE_EVENTS_PER_THREAD (1L << 20)
+
+// Orçamento de memória padrão da ordenação externa
+#define DEFAULT_MEMORY_BUDGET (256L * 1024 * 1024)
+
+// Memória residente além dos buffers que a ordenação externa pode usar:
+// páginas de código e de bibliotecas tocadas pela primeira vez, pilhas das
+// threads, estruturas FILE e a tabela de runs
+#define EXTERNAL_RSS_SLACK (512L * 1024)
+
 enum implementations_enum {
     TYPE_SERIAL = 1,
-    TYPE_PARALLEL
+    TYPE_PARALLEL,
+    TYPE_EXTERNAL,
+    TYPE_MULTIWAY,
+    TYPE_RADIX,
+    TYPE_SAMPLE,
+    TYPE_NETWORK,
+    TYPE_NATURAL,
+    TYPE_KEY_VALUE,
+    TYPE_SELECT,
+    TYPE_POINTS,
+    TYPE_UPDATE
 };
 
+// Nomes aceitos pela opção -m, indexados por implementations_enum
+static const char *implementation_names[] = {
+    [TYPE_PARALLEL] = "parallel",
+    [TYPE_EXTERNAL] = "external",
+    [TYPE_MULTIWAY] = "multiway",
+    [TYPE_RADIX] = "radix",
+    [TYPE_SAMPLE] = "sample",
+    [TYPE_NETWORK] = "network",
+    [TYPE_NATURAL] = "natural",
+    [TYPE_KEY_VALUE] = "keyvalue",
+    [TYPE_SELECT] = "select",
+    [TYPE_POINTS] = "points",
+    [TYPE_UPDATE] = "update"
+};
+
+// Distribuições do vetor de entrada (opção -d)
+enum distributions_enum {
+    DIST_RANDOM = 0,
+    DIST_SORTED,
+    DIST_NEARLY_SORTED,
+    DIST_REVERSE,
+    DIST_FEW_UNIQUE
+};
+
+static const char *distribution_names[] = {
+    [DIST_RANDOM] = "random",
+    [DIST_SORTED] = "sorted",
+    [DIST_NEARLY_SORTED] = "nearly",
+    [DIST_REVERSE] = "reverse",
+    [DIST_FEW_UNIQUE] = "few"
+};
+
+// Nomes aceitos pela opção -i, indexados por simd_isa_enum
+static const char *isa_names[] = {
+    [SIMD_SCALAR] = "scalar",
+    [SIMD_AVX2] = "avx2",
+    [SIMD_AVX512] = "avx512"
+};
+
+// Parâmetros dos modos alternativos, definidos pela linha de comando
+static int fan_in = 8;
+static int oversampling = 32;
+static int network_isa = SIMD_AUTO;
+static int distribution = DIST_RANDOM;
+static long int top_k = 100;
+static long int batch_size = 256;
+
+typedef void (*sort_function_t)(double *array, long int size);
+
 void merge(double *array, long int left, long int mid, long int right) {
     long int n1 = mid - left + 1;
     long int n2 = right - mid;
 
     // Criação de vetores auxiliares (sem dependência compartilhada)
-    double *L = (double*)malloc(n1 * sizeof(double));
-    double *R = (double*)malloc(n2 * sizeof(double));
+    // Os temporários vêm da arena da thread: cada nível da recursão libera
+    // tudo o que alocou com um único arena_reset, sem malloc/free.
+    arena_t *arena = thread_arena();
+    size_t mark = arena_mark(arena);
+    double *L = (double*)arena_alloc(arena, n1 * sizeof(double));
+    double *R = (double*)arena_alloc(arena, n2 * sizeof(double));
     for (long int i = 0; i < n1; i++)
         L[i] = array[left + i];
     for (long int j = 0; j < n2; j++)
@@ -38,8 +116,8 @@ void merge(double *array, long int left, long int mid, long int right) {
     // Continua preenchendo array[k] com elementos restantes
     while (i < n1) array[k++] = L[i++];
     while (j < n2) array[k++] = R[j++];
-    free(L);
-    free(R);
+    arena_reset(arena, mark);
+    TRACE_MERGE(left, mid, right);
 }
 
 void MergeSort_serial(double *array, long int left, long int right) {
@@ -84,41 +162,776 @@ void MergeSort_parallel(double *array, long int left, long int right, int depth)
 }
 
 
+// Define o número de threads e aplica a política de afinidade escolhida
+void set_threads(int number_of_threads, int bind_policy) {
+    omp_set_num_threads(number_of_threads);
+    if (bind_policy != BIND_NONE && bind_omp_threads(bind_policy) != 0) {
+        printf("\nWarning: could not bind all threads");
+    }
+}
+
+
+int parse_implementation(const char *name) {
+    int count = sizeof(implementation_names) / sizeof(implementation_names[0]);
+    for (int i = 0; i < count; i++) {
+        if (implementation_names[i] != NULL && strcmp(implementation_names[i], name) == 0)
+            return i;
+    }
+    return -1;
+}
+
+
+// Converte tamanhos como 512M ou 4G em bytes
+size_t parse_bytes(const char *text) {
+    char *end;
+    size_t value = strtoul(text, &end, 10);
+    switch (*end) {
+    case 'G': case 'g': value <<= 10; /* fall through */
+    case 'M': case 'm': value <<= 10; /* fall through */
+    case 'K': case 'k': value <<= 10;
+    }
+    return value;
+}
+
+
+// Gera um vetor com a distribuição escolhida em -d
+double *generate_vector(long int size) {
+    double *vector = generate_random_double_vector(size, 0.0, 1000.0);
+    if (distribution == DIST_RANDOM)
+        return vector;
+    if (distribution == DIST_FEW_UNIQUE) {
+        // 16 valores distintos
+        for (long int i = 0; i < size; i++)
+            vector[i] = (double)(long int)(vector[i] / 62.5);
+        return vector;
+    }
+
+    MergeSort_serial(vector, 0, size - 1);
+    if (distribution == DIST_REVERSE) {
+        for (long int l = 0, r = size - 1; l < r; l++, r--) {
+            double t = vector[l];
+            vector[l] = vector[r];
+            vector[r] = t;
+        }
+    } else if (distribution == DIST_NEARLY_SORTED) {
+        // 1% dos elementos trocados com um vizinho próximo, como timestamps
+        // que chegam um pouco fora de ordem
+        for (long int s = 0; s < size / 100; s++) {
+            long int i = rand() % size, j = i + rand() % 64;
+            if (j < size) {
+                double t = vector[i];
+                vector[i] = vector[j];
+                vector[j] = t;
+            }
+        }
+    }
+    return vector;
+}
+
+
+// Carrega o vetor da distribuição escolhida (vector.dat para a aleatória,
+// vector_<distribuição>.dat para as outras) ou gera um novo se o arquivo
+// não existe ou tem menos que size elementos
+double *load_or_generate_vector(long int size) {
+    char filename[64] = "vector.dat";
+    if (distribution != DIST_RANDOM)
+        snprintf(filename, sizeof(filename), "vector_%s.dat", distribution_names[distribution]);
+
+    double *vector = NULL;
+    if (access(filename, F_OK) == 0) {
+        printf("\nLoading vector from file...");
+        vector = load_double_vector(filename, size);
+    }
+    if (vector == NULL) {
+        printf("\nGenerating new vector (%s)...", distribution_names[distribution]);
+        vector = generate_vector(size);
+        save_double_vector(vector, size, filename);
+    }
+    return vector;
+}
+
+
+// Ordena vector.dat inteiro em disco e confere a saída sem carregá-la
+// Um campo de /proc/self/status em bytes (VmRSS, VmHWM), -1 se não existe
+long int read_process_memory(const char *field) {
+    FILE *status = fopen("/proc/self/status", "r");
+    if (status == NULL)
+        return -1;
+    char line[256];
+    long int bytes = -1;
+    size_t length = strlen(field);
+    while (fgets(line, sizeof(line), status) != NULL) {
+        if (strncmp(line, field, length) == 0 && line[length] == ':') {
+            bytes = atol(&line[length + 1]) * 1024;
+            break;
+        }
+    }
+    fclose(status);
+    return bytes;
+}
+
+
+// Zera o pico de memória residente (VmHWM) do processo
+int reset_peak_rss(void) {
+    FILE *clear_refs = fopen("/proc/self/clear_refs", "w");
+    if (clear_refs == NULL)
+        return -1;
+    int status = fputs("5", clear_refs) < 0;
+    return (fclose(clear_refs) != 0 || status) ? -1 : 0;
+}
+
+
+int run_external(long int size, size_t memory_budget, const char *temporary_directory) {
+    if (access("vector.dat", F_OK) != 0)
+        free_aligned_memory(load_or_generate_vector(size));
+
+    printf("\nRunning external MergeSort (memory budget %zu bytes, %d threads)...",
+        memory_budget, omp_get_max_threads());
+    external_sort_statistics_t statistics;
+    // O pico de memória residente durante a ordenação, menos o que o
+    // processo já usava antes, não pode passar do orçamento
+    int measure_rss = reset_peak_rss() == 0;
+    long int baseline_rss = read_process_memory("VmRSS");
+    double start = omp_get_wtime();
+    int status = MergeSort_external("vector.dat", "sorted_external.dat",
+        memory_budget, temporary_directory, &statistics);
+    double total_time = omp_get_wtime() - start;
+    long int peak_rss = read_process_memory("VmHWM");
+    if (status != 0) {
+        printf("\nERROR! External sort failed\n");
+        return 1;
+    }
+
+    double megabytes = statistics.elements * sizeof(double) / 1e6;
+    printf("\nElements: %ld | runs: %ld | merge passes: %d | fan-in: %d",
+        statistics.elements, statistics.runs, statistics.merge_passes, statistics.fan_in);
+    printf("\nRun formation: %.6f seconds | merge: %.6f seconds | total: %.6f seconds",
+        statistics.run_time, statistics.merge_time, total_time);
+    // Cada passada (runs + fusões) lê e grava o arquivo inteiro uma vez
+    printf("\nSort throughput: %.1f MB/s | I/O throughput: %.1f MB/s",
+        megabytes / total_time,
+        2.0 * megabytes * (1 + statistics.merge_passes) / total_time);
+
+    int errors = 0;
+    if (measure_rss && baseline_rss >= 0 && peak_rss >= 0) {
+        long int growth = peak_rss - baseline_rss;
+        printf("\nPeak RSS: %.2f MB (%.2f MB before the sort) | growth %.2f MB | budget %.2f MB",
+            peak_rss / 1e6, baseline_rss / 1e6, growth / 1e6, memory_budget / 1e6);
+        if (growth > (long int)memory_budget + EXTERNAL_RSS_SLACK) {
+            printf("\nERROR! The sort used more memory than the budget!");
+            errors++;
+        }
+    } else {
+        printf("\nWarning: could not measure the peak RSS");
+    }
+
+    printf("\nChecking output...");
+    unsigned long input_checksum, output_checksum;
+    int input_sorted, output_sorted;
+    long int input_elements = scan_double_vector_file("vector.dat", &input_checksum, &input_sorted);
+    long int output_elements = scan_double_vector_file("sorted_external.dat", &output_checksum, &output_sorted);
+    if (output_sorted && output_elements == input_elements && output_checksum == input_checksum) {
+        printf("\nOK! Output is sorted and has the same elements as the input!\n");
+        return errors > 0;
+    }
+    printf("\nERROR! Output is not a sorted permutation of the input!\n");
+    return 1;
+}
+
+
+// Imprime o modo de páginas grandes escolhido em -p
+void print_huge_page_mode(void) {
+    int mode = get_huge_page_mode();
+    printf("\nHuge page mode: %s", mode == HUGE_PAGES_EXPLICIT ? "explicit" :
+        (mode == HUGE_PAGES_TRANSPARENT ? "thp" : "none"));
+}
+
+
+// Imprime as falhas de dTLB medidas durante a ordenação
+void print_dtlb_misses(long long misses) {
+    if (misses < 0) {
+        printf("\ndTLB misses: not available");
+    } else {
+        printf("\ndTLB misses: %lld", misses);
+    }
+}
+
+
+// Roda uma variante com 1, 2 e 4 threads e compara cada saída com MergeSort_serial
+int run_variant(const char *name, sort_function_t sort, long int size, int bind_policy) {
+    double *vector = load_or_generate_vector(size);
+    double *vector_serial = (double*)malloc(sizeof(double) * size);
+    memcpy(vector_serial, vector, sizeof(double) * size);
+    set_thread_arena_capacity(sizeof(double) * size + 2 * ALLOCATION_ALIGNMENT);
+
+    print_huge_page_mode();
+    printf("\nRunning serial MergeSort...");
+    double start = omp_get_wtime();
+    MergeSort_serial(vector_serial, 0, size - 1);
+    double time_serial = omp_get_wtime() - start;
+    printf("\nSerial time: %.6f seconds\n", time_serial);
+    save_double_vector(vector_serial, size, "sorted_serial.dat");
+
+    int errors = 0;
+    for (int threads = 1; threads <= 4; threads *= 2) {
+        printf("\n----------------------------------------------\n");
+        set_threads(threads, bind_policy);
+        double *vector_parallel = copy_double_vector_first_touch(vector, size);
+        printf("\nRunning %s (%d threads)...", name, threads);
+        start_dtlb_miss_counters();
+        start = omp_get_wtime();
+        sort(vector_parallel, size);
+        double time_parallel = omp_get_wtime() - start;
+        long long tlb_misses = stop_dtlb_miss_counters();
+        printf("\nParallel time (%d threads): %.6f seconds", threads, time_parallel);
+        print_dtlb_misses(tlb_misses);
+        printf("\n");
+
+        char filename[64];
+        snprintf(filename, sizeof(filename), "sorted_%s_%d.dat", name, threads);
+        save_double_vector(vector_parallel, size, filename);
+        double speedup = time_serial / time_parallel;
+        printf("\nSpeedup (%d threads): %.3f", threads, speedup);
+        printf("\nEficiência (%d threads): %.3f", threads, speedup / threads);
+        if (compare_double_vector_on_files("sorted_serial.dat", filename)) {
+            printf("\nOK! Serial and %s (%d threads) outputs are equal!", name, threads);
+        } else {
+            printf("\nERROR! Outputs are NOT equal for %s with %d threads!", name, threads);
+            errors++;
+        }
+        free_aligned_memory(vector_parallel);
+    }
+
+    free_aligned_memory(vector);
+    free(vector_serial);
+    destroy_thread_arenas();
+    printf("\n");
+    return errors > 0;
+}
+
+
+void sort_multiway(double *array, long int size) {
+    int passes = MergeSort_multiway(array, size, fan_in);
+    printf("\nMemory passes (k = %d): %d", fan_in, passes);
+}
+
+
+void sort_sample(double *array, long int size) {
+    sample_sort_statistics_t statistics;
+    SampleSort_parallel(array, size, oversampling, &statistics);
+    printf("\nBuckets: %d | smallest: %ld | largest: %ld | imbalance (largest / average): %.3f",
+        statistics.buckets, statistics.smallest_bucket, statistics.largest_bucket,
+        statistics.imbalance);
+}
+
+
+void sort_network(double *array, long int size) {
+    int isa = MergeSort_network(array, size, network_isa);
+    printf("\nInstruction set: %s", isa_names[isa]);
+}
+
+
+void sort_natural(double *array, long int size) {
+    natural_sort_statistics_t statistics;
+    MergeSort_natural(array, size, &statistics);
+    printf("\nRuns: %ld | merge levels: %d", statistics.runs, statistics.merge_levels);
+}
+
+
+// Confere pares ordenados: as chaves são as do MergeSort_serial, cada
+// payload aponta para um elemento do vetor original com a mesma chave e
+// chaves iguais mantêm os índices em ordem crescente (estabilidade)
+int check_key_values(const double *vector, const double *sorted, const double *keys,
+                     const long int *values, long int size) {
+    for (long int i = 0; i < size; i++) {
+        if (keys[i] != sorted[i] || values[i] < 0 || values[i] >= size || vector[values[i]] != keys[i])
+            return 0;
+        if (i > 0 && keys[i] == keys[i - 1] && values[i] <= values[i - 1])
+            return 0;
+    }
+    return 1;
+}
+
+
+// Pares (chave, índice) nos layouts AoS e SoA e argsort: com 1 thread roda
+// a versão serial, com 2 e 4 a paralela
+int run_key_value(long int size, int bind_policy) {
+    double *vector = load_or_generate_vector(size);
+    double *sorted = (double*)malloc(sizeof(double) * size);
+    memcpy(sorted, vector, sizeof(double) * size);
+    set_thread_arena_capacity(sizeof(double) * size + 2 * ALLOCATION_ALIGNMENT);
+
+    printf("\nRunning serial MergeSort (keys only)...");
+    double start = omp_get_wtime();
+    MergeSort_serial(sorted, 0, size - 1);
+    double time_serial = omp_get_wtime() - start;
+    printf("\nSerial time: %.6f seconds\n", time_serial);
+
+    const char *layouts[] = { "AoS", "SoA", "argsort" };
+    key_value_t *pairs = (key_value_t*)allocate_aligned_memory(sizeof(key_value_t) * size);
+    double *keys = (double*)allocate_aligned_memory(sizeof(double) * size);
+    long int *values = (long int*)allocate_aligned_memory(sizeof(long int) * size);
+    int errors = 0;
+
+    for (int layout = 0; layout < 3; layout++) {
+        printf("\n----------------------------------------------\n");
+        for (int threads = 1; threads <= 4; threads *= 2) {
+            set_threads(threads, bind_policy);
+            for (long int i = 0; i < size; i++) {
+                pairs[i].key = keys[i] = vector[i];
+                pairs[i].value = values[i] = i;
+            }
+
+            start = omp_get_wtime();
+            if (layout == 0) {
+                if (threads == 1) KeyValueSort_serial(pairs, size);
+                else KeyValueSort_parallel(pairs, size);
+            } else if (layout == 1) {
+                if (threads == 1) KeyValueSort_soa_serial(keys, values, size);
+                else KeyValueSort_soa_parallel(keys, values, size);
+            } else {
+                if (threads == 1) ArgSort_serial(vector, values, size);
+                else ArgSort_parallel(vector, values, size);
+            }
+            double time_sort = omp_get_wtime() - start;
+
+            if (layout == 0) {
+                for (long int i = 0; i < size; i++) {
+                    keys[i] = pairs[i].key;
+                    values[i] = pairs[i].value;
+                }
+            } else if (layout == 2) {
+                permute_double_vector(vector, values, keys, size);
+            }
+            printf("\n%s (%d threads): %.6f seconds | relative to keys-only serial: %.3f",
+                layouts[layout], threads, time_sort, time_serial / time_sort);
+            if (check_key_values(vector, sorted, keys, values, size)) {
+                printf("\nOK! %s (%d threads) keys and payloads are correct!", layouts[layout], threads);
+            } else {
+                printf("\nERROR! %s (%d threads) keys or payloads are wrong!", layouts[layout], threads);
+                errors++;
+            }
+        }
+    }
+
+    free_aligned_memory(pairs);
+    free_aligned_memory(keys);
+    free_aligned_memory(values);
+    free_aligned_memory(vector);
+    free(sorted);
+    destroy_thread_arenas();
+    printf("\n");
+    return errors > 0;
+}
+
+
+// Seleção de alguns percentis e top-k, conferidos contra o vetor ordenado
+// pelo MergeSort_serial
+int run_select(long int size, int bind_policy) {
+    double *vector = load_or_generate_vector(size);
+    double *sorted = (double*)malloc(sizeof(double) * size);
+    memcpy(sorted, vector, sizeof(double) * size);
+    set_thread_arena_capacity(sizeof(double) * size + 2 * ALLOCATION_ALIGNMENT);
+
+    printf("\nRunning serial MergeSort...");
+    double start = omp_get_wtime();
+    MergeSort_serial(sorted, 0, size - 1);
+    double time_serial = omp_get_wtime() - start;
+    printf("\nSerial time: %.6f seconds\n", time_serial);
+
+    long int median = size / 2;
+    double *copy = (double*)malloc(sizeof(double) * size);
+    memcpy(copy, vector, sizeof(double) * size);
+    start = omp_get_wtime();
+    double value = Select_serial(copy, size, median);
+    double time_select = omp_get_wtime() - start;
+    printf("\nSerial selection of the median: %.6f seconds | relative to sort: %.3f",
+        time_select, time_serial / time_select);
+    int errors = 0;
+    if (value != sorted[median]) {
+        printf("\nERROR! Serial selection differs from the sorted vector!");
+        errors++;
+    }
+    free(copy);
+
+    long int ranks[] = { 0, size / 100, median, size - 1 - size / 100, size - 1 };
+    if (top_k > size)
+        top_k = size;
+    double *top = (double*)malloc(sizeof(double) * (top_k > 0 ? top_k : 1));
+
+    for (int threads = 1; threads <= 4; threads *= 2) {
+        printf("\n----------------------------------------------\n");
+        set_threads(threads, bind_policy);
+
+        start = omp_get_wtime();
+        value = Select_parallel(vector, size, median);
+        time_select = omp_get_wtime() - start;
+        printf("\nParallel selection of the median (%d threads): %.6f seconds | relative to sort: %.3f",
+            threads, time_select, time_serial / time_select);
+        int wrong = (value != sorted[median]);
+        for (int r = 0; r < 5; r++)
+            wrong += (Select_parallel(vector, size, ranks[r]) != sorted[ranks[r]]);
+
+        start = omp_get_wtime();
+        TopK_parallel(vector, size, top_k, top);
+        double time_top = omp_get_wtime() - start;
+        printf("\nTop-%ld (%d threads): %.6f seconds | relative to sort: %.3f",
+            top_k, threads, time_top, time_serial / time_top);
+        if (memcmp(top, sorted, sizeof(double) * top_k) != 0)
+            wrong++;
+
+        if (wrong == 0) {
+            printf("\nOK! Selection and top-k (%d threads) match the sorted vector!", threads);
+        } else {
+            printf("\nERROR! Selection or top-k (%d threads) differ from the sorted vector!", threads);
+            errors++;
+        }
+    }
+
+    free(top);
+    free_aligned_memory(vector);
+    free(sorted);
+    destroy_thread_arenas();
+    printf("\n");
+    return errors > 0;
+}
+
+
+// Ordena points.dat por x, (x, y), Morton e Hilbert com 1, 2 e 4 threads.
+// As ordens por coordenada são conferidas diretamente; todas as saídas com
+// 2 e 4 threads precisam ser iguais à de 1 thread (as ordenações são estáveis).
+int run_points(long int size, int bind_policy) {
+    point2D_t *points = NULL;
+    if (access("points.dat", F_OK) == 0) {
+        printf("\nLoading points from file...");
+        points = load_2Dpoints_vector("points.dat", size);
+    }
+    if (points == NULL) {
+        printf("\nGenerating new points...");
+        points = generate_random_2Dpoints_vector(size, 0.0, 1000.0);
+        save_2Dpoints_vector(points, size, "points.dat");
+    }
+    printf("\nMean step between consecutive points (input order): %.6f\n", mean_point_step(points, size));
+
+    const char *orders[] = { "x", "xy", "morton", "hilbert" };
+    point2D_t *sorted = (point2D_t*)allocate_aligned_memory(sizeof(point2D_t) * (size > 0 ? size : 1));
+    int errors = 0;
+
+    for (int order = POINT_ORDER_X; order <= POINT_ORDER_HILBERT; order++) {
+        printf("\n----------------------------------------------\n");
+        for (int threads = 1; threads <= 4; threads *= 2) {
+            set_threads(threads, bind_policy);
+            memcpy(sorted, points, sizeof(point2D_t) * size);
+            double start = omp_get_wtime();
+            PointSort_parallel(sorted, size, order);
+            double time_sort = omp_get_wtime() - start;
+            printf("\nSort by %s (%d threads): %.6f seconds", orders[order], threads, time_sort);
+
+            int ok = 1;
+            for (long int i = 1; i < size && order <= POINT_ORDER_XY; i++) {
+                if (sorted[i].x < sorted[i - 1].x ||
+                    (order == POINT_ORDER_XY && sorted[i].x == sorted[i - 1].x && sorted[i].y < sorted[i - 1].y))
+                    ok = 0;
+            }
+            char filename[64];
+            snprintf(filename, sizeof(filename), "sorted_points_%s_%d.dat", orders[order], threads);
+            save_2Dpoints_vector(sorted, size, filename);
+            if (threads == 1) {
+                printf("\nMean step between consecutive points: %.6f", mean_point_step(sorted, size));
+            } else {
+                char reference[64];
+                snprintf(reference, sizeof(reference), "sorted_points_%s_1.dat", orders[order]);
+                ok = ok && compare_2Dpoints_vector_on_files(reference, filename);
+            }
+            if (ok) {
+                printf("\nOK! Points sorted by %s (%d threads)!", orders[order], threads);
+            } else {
+                printf("\nERROR! Points are NOT sorted by %s with %d threads!", orders[order], threads);
+                errors++;
+            }
+        }
+    }
+
+    free_aligned_memory(sorted);
+    free_aligned_memory(points);
+    destroy_thread_arenas();
+    printf("\n");
+    return errors > 0;
+}
+
+
+// Aplica lotes de batch_size atualizações a um vetor ordenado com
+// MergeSort_update e confere contra a reordenação completa pelo
+// MergeSort_serial depois de aplicar o mesmo lote
+int run_update(long int size, int bind_policy) {
+    double *sorted = load_or_generate_vector(size);
+    set_thread_arena_capacity(sizeof(double) * size + 2 * ALLOCATION_ALIGNMENT);
+    MergeSort_serial(sorted, 0, size - 1);
+    if (size <= 0)
+        batch_size = 0;
+
+    long int *indices = (long int*)malloc(sizeof(long int) * (batch_size > 0 ? batch_size : 1));
+    double *values = (double*)malloc(sizeof(double) * (batch_size > 0 ? batch_size : 1));
+    for (long int b = 0; b < batch_size; b++) {
+        indices[b] = rand() % size;
+        values[b] = 1000.0 * rand() / RAND_MAX;
+    }
+
+    double *reference = (double*)malloc(sizeof(double) * size);
+    memcpy(reference, sorted, sizeof(double) * size);
+    printf("\nRunning serial MergeSort after %ld updates...", batch_size);
+    double start = omp_get_wtime();
+    for (long int b = 0; b < batch_size; b++)
+        reference[indices[b]] = values[b];
+    MergeSort_serial(reference, 0, size - 1);
+    double time_serial = omp_get_wtime() - start;
+    printf("\nSerial time: %.6f seconds\n", time_serial);
+
+    int errors = 0;
+    double *updated = (double*)malloc(sizeof(double) * size);
+    for (int threads = 1; threads <= 4; threads *= 2) {
+        printf("\n----------------------------------------------\n");
+        set_threads(threads, bind_policy);
+        memcpy(updated, sorted, sizeof(double) * size);
+        start = omp_get_wtime();
+        MergeSort_update(updated, size, indices, values, batch_size);
+        double time_update = omp_get_wtime() - start;
+        printf("\nIncremental update (%d threads): %.6f seconds | relative to re-sort: %.3f",
+            threads, time_update, time_serial / time_update);
+        if (memcmp(updated, reference, sizeof(double) * size) == 0) {
+            printf("\nOK! Incremental update (%d threads) matches the re-sorted vector!", threads);
+        } else {
+            printf("\nERROR! Incremental update (%d threads) differs from the re-sorted vector!", threads);
+            errors++;
+        }
+    }
+
+    free(indices);
+    free(values);
+    free(reference);
+    free(updated);
+    free_aligned_memory(sorted);
+    destroy_thread_arenas();
+    printf("\n");
+    return errors > 0;
+}
+
+
+// Radix sort dos doubles contra o MergeSort_serial e, em seguida, da
+// versão para ints (vector_int.dat) contra o merge sort dos mesmos valores
+int run_radix(long int size, int bind_policy) {
+    int errors = run_variant("radix", RadixSort_double, size, bind_policy);
+
+    int *vector_int = NULL;
+    if (access("vector_int.dat", F_OK) == 0) {
+        printf("\nLoading int vector from file...");
+        vector_int = load_int_vector("vector_int.dat", size);
+    }
+    if (vector_int == NULL) {
+        printf("\nGenerating new int vector...");
+        vector_int = generate_random_int_vector(size, 0, 1000000);
+        // Metade negativa, para exercitar o bit de sinal das chaves
+        for (long int i = 0; i < size; i += 2)
+            vector_int[i] = -vector_int[i];
+        save_int_vector(vector_int, size, "vector_int.dat");
+    }
+    double *reference = (double*)malloc(sizeof(double) * size);
+    for (long int i = 0; i < size; i++)
+        reference[i] = vector_int[i];
+    MergeSort_serial(reference, 0, size - 1);
+
+    printf("\nRunning int radix sort (%d threads)...", omp_get_max_threads());
+    double start = omp_get_wtime();
+    RadixSort_int(vector_int, size);
+    printf("\nInt radix sort time: %.6f seconds", omp_get_wtime() - start);
+
+    long int i = 0;
+    while (i < size && reference[i] == vector_int[i])
+        i++;
+    if (i == size) {
+        printf("\nOK! Int radix sort and MergeSort outputs are equal!\n");
+    } else {
+        printf("\nERROR! Int radix sort differs from MergeSort at position %ld!\n", i);
+        errors++;
+    }
+    free(reference);
+    free_aligned_memory(vector_int);
+    destroy_thread_arenas();
+    return errors > 0;
+}
+
+
 int main(int argc, char **argv) {
     srand(time(NULL));
-    double *vector_serial, *vector_2, *vector_4;
-    if (access("vector.dat", F_OK) != 0) {
-        printf("\nGenerating new vector...");
-        vector_serial = generate_random_double_vector(SIZE, 0.0, 1000.0);
-        save_double_vector(vector_serial, SIZE, "vector.dat");
-    } else {
-        printf("\nLoading vector from file...");
-        vector_serial = load_double_vector("vector.dat", SIZE);
+    int bind_policy = BIND_NONE;
+    int implementation = TYPE_PARALLEL;
+    long int size = SIZE;
+    size_t memory_budget = DEFAULT_MEMORY_BUDGET;
+    const char *temporary_directory = "/tmp";
+    int huge_page_mode = HUGE_PAGES_NONE;
+    int opt;
+    while ((opt = getopt(argc, argv, "b:d:i:m:n:k:p:s:t:u:M:T:")) != -1) {
+        switch (opt) {
+        case 'b':
+            bind_policy = parse_bind_policy(optarg);
+            if (bind_policy < 0) {
+                fprintf(stderr, "Unknown binding policy: %s\n", optarg);
+                return 1;
+            }
+            break;
+        case 'd':
+            for (distribution = DIST_FEW_UNIQUE; distribution >= DIST_RANDOM; distribution--) {
+                if (strcmp(distribution_names[distribution], optarg) == 0)
+                    break;
+            }
+            if (distribution < DIST_RANDOM) {
+                fprintf(stderr, "Unknown distribution: %s\n", optarg);
+                return 1;
+            }
+            break;
+        case 'i':
+            if (strcmp(optarg, "auto") == 0) {
+                network_isa = SIMD_AUTO;
+                break;
+            }
+            for (network_isa = SIMD_AVX512; network_isa >= SIMD_SCALAR; network_isa--) {
+                if (strcmp(isa_names[network_isa], optarg) == 0)
+                    break;
+            }
+            if (network_isa < SIMD_SCALAR) {
+                fprintf(stderr, "Unknown instruction set: %s\n", optarg);
+                return 1;
+            }
+            if (network_isa > best_simd_isa()) {
+                fprintf(stderr, "Instruction set not supported by this CPU: %s\n", optarg);
+                return 1;
+            }
+            break;
+        case 'm':
+            implementation = parse_implementation(optarg);
+            if (implementation < 0) {
+                fprintf(stderr, "Unknown implementation: %s\n", optarg);
+                return 1;
+            }
+            break;
+        case 'n':
+            size = atol(optarg);
+            break;
+        case 'k':
+            fan_in = atoi(optarg);
+            break;
+        case 's':
+            oversampling = atoi(optarg);
+            break;
+        case 't':
+            top_k = atol(optarg);
+            break;
+        case 'u':
+            batch_size = atol(optarg);
+            break;
+        case 'p':
+            huge_page_mode = parse_huge_page_mode(optarg);
+            if (huge_page_mode < 0) {
+                fprintf(stderr, "Unknown huge page mode: %s\n", optarg);
+                return 1;
+            }
+            break;
+        case 'M':
+            memory_budget = parse_bytes(optarg);
+            break;
+        case 'T':
+            temporary_directory = optarg;
+            break;
+        default:
+            fprintf(stderr, "Usage: %s [-m parallel|external|multiway|radix|sample|network|natural|keyvalue|select|points|update]\n"
+                "          [-n size] [-d random|sorted|nearly|reverse|few] [-b none|compact|scatter]\n"
+                "          [-k fan-in] [-s oversampling] [-t top-k count] [-u update batch size]\n"
+                "          [-i auto|scalar|avx2|avx512] [-p none|thp|explicit]\n"
+                "          [-M memory budget, e.g. 512M] [-T temporary directory]\n", argv[0]);
+            return 1;
+        }
     }
-    vector_2 = (double*)malloc(sizeof(double) * SIZE);
-    vector_4 = (double*)malloc(sizeof(double) * SIZE);
-    memcpy(vector_2, vector_serial, sizeof(double) * SIZE);
-    memcpy(vector_4, vector_serial, sizeof(double) * SIZE);
+
+    // Vale para todos os vetores alocados pela LibPPC daqui em diante
+    set_huge_page_mode(huge_page_mode);
+    set_threads(omp_get_num_procs(), bind_policy);
+    if (implementation == TYPE_EXTERNAL)
+        return run_external(size, memory_budget, temporary_directory);
+    if (implementation == TYPE_MULTIWAY)
+        return run_variant("multiway", sort_multiway, size, bind_policy);
+    if (implementation == TYPE_RADIX)
+        return run_radix(size, bind_policy);
+    if (implementation == TYPE_SAMPLE)
+        return run_variant("sample", sort_sample, size, bind_policy);
+    if (implementation == TYPE_NETWORK)
+        return run_variant("network", sort_network, size, bind_policy);
+    if (implementation == TYPE_NATURAL)
+        return run_variant("natural", sort_natural, size, bind_policy);
+    if (implementation == TYPE_KEY_VALUE)
+        return run_key_value(size, bind_policy);
+    if (implementation == TYPE_SELECT)
+        return run_select(size, bind_policy);
+    if (implementation == TYPE_POINTS)
+        return run_points(size, bind_policy);
+    if (implementation == TYPE_UPDATE)
+        return run_update(size, bind_policy);
+
+    // A maior fusão (a última) precisa de size doubles de temporários
+    set_thread_arena_capacity(sizeof(double) * size + 2 * ALLOCATION_ALIGNMENT);
+
+    double *vector_serial, *vector_2, *vector_4;
+    vector_serial = load_or_generate_vector(size);
+    // Cópias feitas pelas próprias threads (first-touch), com o mesmo número
+    // de threads da execução, para que cada metade/quarto do vetor fique no
+    // nó NUMA da thread que vai ordená-lo.
+    set_threads(2, bind_policy);
+    vector_2 = copy_double_vector_first_touch(vector_serial, size);
+    set_threads(4, bind_policy);
+    vector_4 = copy_double_vector_first_touch(vector_serial, size);
 
     double start, end, time_serial = 0, time_parallel_2 = 0, time_parallel_4 = 0;
+    long long tlb_misses;
+    print_huge_page_mode();
+#ifdef __TRACE__
+    trace_start(TRACE_THREADS, TRACE_EVENTS_PER_THREAD);
+#endif
+
     printf("\nRunning serial MergeSort...");
+    reset_thread_arena_statistics();
+    TRACE_BEGIN(1);
+    start_dtlb_miss_counters();
     start = omp_get_wtime();
-    MergeSort_serial(vector_serial, 0, SIZE - 1);
+    MergeSort_serial(vector_serial, 0, size - 1);
     end = omp_get_wtime();
+    tlb_misses = stop_dtlb_miss_counters();
     time_serial = end - start;
-    printf("\nSerial time: %.6f seconds\n", time_serial);
-    save_double_vector(vector_serial, SIZE, "sorted_serial.dat");
+    printf("\nSerial time: %.6f seconds", time_serial);
+    print_dtlb_misses(tlb_misses);
+    printf("\n");
+    print_thread_arena_statistics();
+    printf("\n");
+    save_double_vector(vector_serial, size, "sorted_serial.dat");
 
     printf("\n----------------------------------------------\n");
 
-    omp_set_num_threads(2);
+    set_threads(2, bind_policy);
     printf("\nRunning parallel MergeSort (2 threads)...");
+    reset_thread_arena_statistics();
+    TRACE_BEGIN(2);
+    start_dtlb_miss_counters();
     start = omp_get_wtime();
-    MergeSort_parallel(vector_2, 0, SIZE - 1, 1);
+    MergeSort_parallel(vector_2, 0, size - 1, 1);
     end = omp_get_wtime();
+    tlb_misses = stop_dtlb_miss_counters();
     time_parallel_2 = end - start;
-    printf("\nParallel time (2 threads): %.6f seconds\n", time_parallel_2);
-    save_double_vector(vector_2, SIZE, "sorted_parallel_2.dat");
+    printf("\nParallel time (2 threads): %.6f seconds", time_parallel_2);
+    print_dtlb_misses(tlb_misses);
+    printf("\n");
+    print_omp_thread_placement();
+    print_numa_placement(vector_2, sizeof(double) * size, "vector_2");
+    print_thread_arena_statistics();
+    printf("\n");
+    save_double_vector(vector_2, size, "sorted_parallel_2.dat");
     double speedup_2 = time_serial / time_parallel_2;
     double eficiencia_2 = speedup_2 / 2.0;
     printf("\nSpeedup (2 threads): %.3f", speedup_2);
@@ -126,14 +939,24 @@ int main(int argc, char **argv) {
 
     printf("\n----------------------------------------------\n");
 
-    omp_set_num_threads(4);
+    set_threads(4, bind_policy);
     printf("\nRunning parallel MergeSort (4 threads)...");
+    reset_thread_arena_statistics();
+    TRACE_BEGIN(4);
+    start_dtlb_miss_counters();
     start = omp_get_wtime();
-    MergeSort_parallel(vector_4, 0, SIZE - 1, 2);
+    MergeSort_parallel(vector_4, 0, size - 1, 2);
     end = omp_get_wtime();
+    tlb_misses = stop_dtlb_miss_counters();
     time_parallel_4 = end - start;
-    printf("\nParallel time (4 threads): %.6f seconds\n", time_parallel_4);
-    save_double_vector(vector_4, SIZE, "sorted_parallel_4.dat");
+    printf("\nParallel time (4 threads): %.6f seconds", time_parallel_4);
+    print_dtlb_misses(tlb_misses);
+    printf("\n");
+    print_omp_thread_placement();
+    print_numa_placement(vector_4, sizeof(double) * size, "vector_4");
+    print_thread_arena_statistics();
+    printf("\n");
+    save_double_vector(vector_4, size, "sorted_parallel_4.dat");
     double speedup_4 = time_serial / time_parallel_4;
     double eficiencia_4 = speedup_4 / 4.0;
     printf("\nSpeedup (4 threads): %.3f", speedup_4);
@@ -159,9 +982,15 @@ int main(int argc, char **argv) {
         printf("\nERROR! Outputs are NOT equal for 4 threads!");
     }
 
-    free(vector_serial);
-    free(vector_2);
-    free(vector_4);
+#ifdef __TRACE__
+    printf("\nTrace: %ld events saved on trace.dat", trace_save("trace.dat"));
+    trace_stop();
+#endif
+
+    free_aligned_memory(vector_serial);
+    free_aligned_memory(vector_2);
+    free_aligned_memory(vector_4);
+    destroy_thread_arenas();
     printf("\n");
     return 0;
 }
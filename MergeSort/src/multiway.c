@@ -0,0 +1,239 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <libppc.h>
+#include <omp.h>
+
+#include "mergesort.h"
+
+// Blocos da primeira fase: 4096 doubles (32 KiB) cabem na cache L1/L2,
+// então ordená-los não gera tráfego com a memória principal.
+#define MULTIWAY_BLOCK 4096
+
+
+// A fonte a vence a fonte b: fontes esgotadas perdem sempre e, em caso de
+// empate, vence a de menor índice (a fusão fica estável).
+static int beats(const loser_tree_t *tree, int a, int b) {
+    if (tree->exhausted[a])
+        return 0;
+    if (tree->exhausted[b])
+        return 1;
+    if (tree->keys[a] != tree->keys[b])
+        return tree->keys[a] < tree->keys[b];
+    return a < b;
+}
+
+
+void loser_tree_init(loser_tree_t *tree, int k, arena_t *arena) {
+    tree->k = k;
+    tree->nodes = (int*)arena_alloc(arena, sizeof(int) * k);
+    tree->keys = (double*)arena_alloc(arena, sizeof(double) * k);
+    tree->exhausted = (int*)arena_alloc(arena, sizeof(int) * k);
+    memset(tree->exhausted, 0, sizeof(int) * k);
+}
+
+
+void loser_tree_build(loser_tree_t *tree, arena_t *arena) {
+    int k = tree->k;
+    size_t mark = arena_mark(arena);
+
+    // As folhas ficam nas posições k..2k-1 de uma árvore binária implícita;
+    // cada nó interno guarda o perdedor do jogo e o vencedor sobe.
+    int *winners = (int*)arena_alloc(arena, sizeof(int) * 2 * k);
+    for (int i = 0; i < k; i++)
+        winners[k + i] = i;
+    for (int p = k - 1; p >= 1; p--) {
+        int a = winners[2 * p], b = winners[2 * p + 1];
+        if (beats(tree, a, b)) {
+            winners[p] = a;
+            tree->nodes[p] = b;
+        } else {
+            winners[p] = b;
+            tree->nodes[p] = a;
+        }
+    }
+    tree->nodes[0] = (k > 1) ? winners[1] : 0;
+    arena_reset(arena, mark);
+}
+
+
+void loser_tree_replay(loser_tree_t *tree, int source) {
+    // Só o caminho da folha até a raiz é rejogado: log2(k) comparações
+    int winner = source;
+    for (int p = (source + tree->k) / 2; p >= 1; p /= 2) {
+        if (beats(tree, tree->nodes[p], winner)) {
+            int loser = winner;
+            winner = tree->nodes[p];
+            tree->nodes[p] = loser;
+        }
+    }
+    tree->nodes[0] = winner;
+}
+
+
+// Funde k runs ordenados [begin[r], end[r]) em output
+static void multiway_merge(const double **begin, const double **end, int k, double *output) {
+    arena_t *arena = thread_arena();
+    size_t mark = arena_mark(arena);
+    loser_tree_t tree;
+    loser_tree_init(&tree, k, arena);
+    const double **position = (const double**)arena_alloc(arena, sizeof(double*) * k);
+
+    long int total = 0;
+    for (int r = 0; r < k; r++) {
+        position[r] = begin[r];
+        total += end[r] - begin[r];
+        if (begin[r] < end[r])
+            tree.keys[r] = *begin[r];
+        else
+            tree.exhausted[r] = 1;
+    }
+    loser_tree_build(&tree, arena);
+
+    for (long int i = 0; i < total; i++) {
+        int r = loser_tree_winner(&tree);
+        output[i] = tree.keys[r];
+        if (++position[r] < end[r])
+            tree.keys[r] = *position[r];
+        else
+            tree.exhausted[r] = 1;
+        loser_tree_replay(&tree, r);
+    }
+    arena_reset(arena, mark);
+}
+
+
+// Primeira posição de [begin, end) com valor >= value
+static const double *lower_bound(const double *begin, const double *end, double value) {
+    while (begin < end) {
+        const double *middle = begin + (end - begin) / 2;
+        if (*middle < value)
+            begin = middle + 1;
+        else
+            end = middle;
+    }
+    return begin;
+}
+
+
+static int compare_doubles(const void *a, const void *b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+
+// Uma fusão independente: um grupo de runs inteiro ou um trecho dele
+typedef struct {
+    const double *begin[MULTIWAY_MAX_FAN_IN];
+    const double *end[MULTIWAY_MAX_FAN_IN];
+    int k;
+    double *output;
+} merge_task_t;
+
+
+// Divide a fusão de um grupo em parts trechos independentes. Os divisores
+// são amostras dos próprios runs; como cada run é cortado no lower_bound
+// do mesmo valor, tudo antes do corte é menor que tudo depois dele.
+static int split_group(const double **begin, const double **end, int k, double *output,
+                       int parts, merge_task_t *tasks) {
+    int samples_per_run = parts;
+    double *samples = (double*)malloc(sizeof(double) * k * samples_per_run);
+    int number_of_samples = 0;
+    for (int r = 0; r < k; r++) {
+        long int length = end[r] - begin[r];
+        for (int s = 1; s <= samples_per_run && length > 0; s++)
+            samples[number_of_samples++] = begin[r][(length * s) / (samples_per_run + 1)];
+    }
+    qsort(samples, number_of_samples, sizeof(double), compare_doubles);
+
+    const double *cut[MULTIWAY_MAX_FAN_IN];
+    for (int r = 0; r < k; r++)
+        cut[r] = begin[r];
+
+    int number_of_tasks = 0;
+    for (int p = 0; p < parts; p++) {
+        merge_task_t *task = &tasks[number_of_tasks++];
+        task->k = k;
+        task->output = output;
+        for (int r = 0; r < k; r++) {
+            task->begin[r] = cut[r];
+            if (p == parts - 1 || number_of_samples == 0) {
+                task->end[r] = end[r];
+            } else {
+                double splitter = samples[((long int)number_of_samples * (p + 1)) / parts];
+                task->end[r] = lower_bound(cut[r], end[r], splitter);
+            }
+            output += task->end[r] - task->begin[r];
+            cut[r] = task->end[r];
+        }
+    }
+    free(samples);
+    return number_of_tasks;
+}
+
+
+int MergeSort_multiway(double *array, long int size, int k) {
+    if (k < 2)
+        k = 2;
+    if (k > MULTIWAY_MAX_FAN_IN)
+        k = MULTIWAY_MAX_FAN_IN;
+
+    // Fase 1: blocos do tamanho da cache, ordenados em paralelo
+    long int number_of_blocks = (size + MULTIWAY_BLOCK - 1) / MULTIWAY_BLOCK;
+    #pragma omp parallel for schedule(static)
+    for (long int b = 0; b < number_of_blocks; b++) {
+        long int left = b * MULTIWAY_BLOCK;
+        long int right = (left + MULTIWAY_BLOCK < size ? left + MULTIWAY_BLOCK : size) - 1;
+        MergeSort_serial(array, left, right);
+    }
+    int passes = 1;
+
+    // Fase 2: cada passada funde grupos de k runs, então são log_k(N/B)
+    // passadas sobre a memória em vez de log2(N/B).
+    double *buffer = (double*)allocate_aligned_memory(sizeof(double) * (size > 0 ? size : 1));
+    double *source = array, *destination = buffer;
+    int threads = omp_get_max_threads();
+
+    for (long int run_length = MULTIWAY_BLOCK; run_length < size; run_length *= k) {
+        long int group_length = run_length * k;
+        long int groups = (size + group_length - 1) / group_length;
+        // Poucos grupos (as últimas passadas) são divididos em trechos para
+        // que todas as threads tenham trabalho
+        int parts = (groups < threads) ? (int)((threads + groups - 1) / groups) : 1;
+        merge_task_t *tasks = (merge_task_t*)malloc(sizeof(merge_task_t) * groups * parts);
+        long int number_of_tasks = 0;
+
+        for (long int g = 0; g < groups; g++) {
+            const double *begin[MULTIWAY_MAX_FAN_IN], *end[MULTIWAY_MAX_FAN_IN];
+            long int group_start = g * group_length;
+            int runs = 0;
+            for (long int start = group_start; start < size && start < group_start + group_length;
+                 start += run_length) {
+                begin[runs] = source + start;
+                end[runs] = source + (start + run_length < size ? start + run_length : size);
+                runs++;
+            }
+            number_of_tasks += split_group(begin, end, runs, destination + group_start,
+                                           parts, &tasks[number_of_tasks]);
+        }
+
+        #pragma omp parallel for schedule(dynamic)
+        for (long int t = 0; t < number_of_tasks; t++)
+            multiway_merge(tasks[t].begin, tasks[t].end, tasks[t].k, tasks[t].output);
+
+        free(tasks);
+        double *swap = source;
+        source = destination;
+        destination = swap;
+        passes++;
+    }
+
+    if (source != array) {
+        #pragma omp parallel for schedule(static)
+        for (long int i = 0; i < size; i++)
+            array[i] = source[i];
+        passes++;
+    }
+    free_aligned_memory(buffer);
+    return passes;
+}
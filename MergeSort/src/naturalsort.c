@@ -0,0 +1,188 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <libppc.h>
+#include <omp.h>
+
+#include "mergesort.h"
+
+// Runs naturais mais curtos que isso são estendidos por inserção: fundir
+// muitos runs minúsculos custa mais que ordená-los diretamente.
+#define MIN_RUN 32
+
+// Vitórias seguidas de um mesmo lado antes de passar a galopar
+#define MIN_GALLOP 7
+
+
+// Número de elementos do prefixo de a[0..n) que satisfazem a[i] < key
+// (ou a[i] <= key se inclusive): busca exponencial seguida de binária,
+// O(log d) onde d é a resposta, em vez de O(log n).
+static long int gallop(double key, const double *a, long int n, int inclusive) {
+    long int low = 0, step = 1;
+    while (low + step <= n && (inclusive ? a[low + step - 1] <= key : a[low + step - 1] < key)) {
+        low += step;
+        step *= 2;
+    }
+    long int high = (low + step < n) ? low + step : n;
+    while (low < high) {
+        long int middle = low + (high - low) / 2;
+        if (inclusive ? a[middle] <= key : a[middle] < key)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    return low;
+}
+
+
+// Ordenação por inserção binária de array[left..right), sabendo que
+// array[left..sorted) já está em ordem
+static void binary_insertion_sort(double *array, long int left, long int sorted, long int right) {
+    for (long int i = sorted; i < right; i++) {
+        double value = array[i];
+        long int position = left + gallop(value, array + left, i - left, 1);
+        memmove(&array[position + 1], &array[position], sizeof(double) * (i - position));
+        array[position] = value;
+    }
+}
+
+
+// Detecta os runs de array[first..last): crescentes (a[i] <= a[i+1]) ou
+// estritamente decrescentes, que são invertidos no lugar. Grava o início
+// de cada run em starts e retorna quantos são.
+static long int find_runs(double *array, long int first, long int last, long int *starts) {
+    long int runs = 0, i = first;
+    while (i < last) {
+        long int end = i + 1;
+        if (end < last && array[end] < array[i]) {
+            while (end < last && array[end] < array[end - 1])
+                end++;
+            for (long int l = i, r = end - 1; l < r; l++, r--) {
+                double t = array[l];
+                array[l] = array[r];
+                array[r] = t;
+            }
+        } else {
+            while (end < last && array[end] >= array[end - 1])
+                end++;
+        }
+        if (end - i < MIN_RUN) {
+            long int extended = (i + MIN_RUN < last) ? i + MIN_RUN : last;
+            binary_insertion_sort(array, i, end, extended);
+            end = extended;
+        }
+        starts[runs++] = i;
+        i = end;
+    }
+    return runs;
+}
+
+
+// Funde os runs adjacentes array[left..mid) e array[mid..right) no lugar
+static void merge_runs(double *array, long int left, long int mid, long int right) {
+    // Runs já em ordem entre si (o caso comum em dados quase ordenados)
+    if (array[mid - 1] <= array[mid])
+        return;
+
+    // O prefixo do run da esquerda <= array[mid] e o sufixo do run da
+    // direita >= array[mid - 1] já estão no lugar certo
+    left += gallop(array[mid], array + left, mid - left, 1);
+    right = mid + gallop(array[mid - 1], array + mid, right - mid, 0);
+
+    // Só a parte restante do run da esquerda vai para o temporário; a
+    // escrita (k) nunca alcança a leitura do run da direita (j).
+    arena_t *arena = thread_arena();
+    size_t mark = arena_mark(arena);
+    long int na = mid - left;
+    double *a = (double*)arena_alloc(arena, sizeof(double) * na);
+    memcpy(a, &array[left], sizeof(double) * na);
+
+    long int i = 0, j = mid, k = left;
+    int wins_a = 0, wins_b = 0;
+    while (i < na && j < right) {
+        if (array[j] < a[i]) {
+            array[k++] = array[j++];
+            wins_a = 0;
+            // O run da direita está ganhando seguido: copia em bloco todos
+            // os seus elementos menores que a[i]
+            if (++wins_b >= MIN_GALLOP) {
+                long int n = gallop(a[i], &array[j], right - j, 0);
+                memmove(&array[k], &array[j], sizeof(double) * n);
+                k += n;
+                j += n;
+                wins_b = 0;
+            }
+        } else {
+            array[k++] = a[i++];
+            wins_b = 0;
+            if (++wins_a >= MIN_GALLOP) {
+                long int n = gallop(array[j], &a[i], na - i, 1);
+                memcpy(&array[k], &a[i], sizeof(double) * n);
+                k += n;
+                i += n;
+                wins_a = 0;
+            }
+        }
+    }
+    // O que sobra do run da direita já está no lugar
+    memcpy(&array[k], &a[i], sizeof(double) * (na - i));
+    arena_reset(arena, mark);
+}
+
+
+void MergeSort_natural(double *array, long int size, natural_sort_statistics_t *statistics) {
+    if (statistics != NULL)
+        memset(statistics, 0, sizeof(natural_sort_statistics_t));
+    if (size < 2)
+        return;
+
+    // Fase 1: cada thread detecta os runs do seu trecho (um run nunca
+    // atravessa a fronteira entre trechos)
+    int threads = omp_get_max_threads();
+    long int *starts = (long int*)malloc(sizeof(long int) * (size + 1));
+    long int *chunk_runs = (long int*)calloc(threads, sizeof(long int));
+
+    #pragma omp parallel num_threads(threads)
+    {
+        int t = omp_get_thread_num();
+        int team = omp_get_num_threads();
+        long int first = size * t / team, last = size * (t + 1) / team;
+        // Um trecho de n elementos tem no máximo n runs: o trecho t usa a
+        // própria faixa de starts e depois as faixas são compactadas
+        chunk_runs[t] = find_runs(array, first, last, &starts[first]);
+        #pragma omp barrier
+        #pragma omp single
+        {
+            long int runs = 0;
+            for (int u = 0; u < team; u++) {
+                long int u_first = size * u / team;
+                memmove(&starts[runs], &starts[u_first], sizeof(long int) * chunk_runs[u]);
+                runs += chunk_runs[u];
+            }
+            chunk_runs[0] = runs;
+        }
+    }
+    long int runs = chunk_runs[0];
+    starts[runs] = size;
+    if (statistics != NULL)
+        statistics->runs = runs;
+
+    // Fase 2: fusões de pares de runs vizinhos, nível a nível; as fusões de
+    // um nível são independentes e vão para threads diferentes
+    while (runs > 1) {
+        #pragma omp parallel for schedule(dynamic)
+        for (long int r = 0; r < runs - 1; r += 2)
+            merge_runs(array, starts[r], starts[r + 1], starts[r + 2]);
+
+        long int merged = 0;
+        for (long int r = 0; r < runs; r += 2)
+            starts[merged++] = starts[r];
+        starts[merged] = size;
+        runs = merged;
+        if (statistics != NULL)
+            statistics->merge_levels++;
+    }
+
+    free(starts);
+    free(chunk_runs);
+}
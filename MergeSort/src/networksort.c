@@ -0,0 +1,346 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <immintrin.h>
+#include <libppc.h>
+#include <omp.h>
+
+#include "mergesort.h"
+
+// As funções SIMD são compiladas para o seu conjunto de instruções com o
+// atributo target e escolhidas em tempo de execução, então o Makefile não
+// precisa de -mavx2/-mavx512f e o binário roda em qualquer x86-64.
+#define AVX2 __attribute__((target("avx2")))
+#define AVX512 __attribute__((target("avx512f")))
+
+// Comparadores (i, j) das redes de ordenação ótimas de 4 e 8 entradas,
+// aplicados entre registradores: cada coluna (lane) fica ordenada.
+static const int network4[][2] = {
+    {0, 1}, {2, 3}, {0, 2}, {1, 3}, {1, 2}
+};
+static const int network8[][2] = {
+    {0, 2}, {1, 3}, {4, 6}, {5, 7},
+    {0, 4}, {1, 5}, {2, 6}, {3, 7},
+    {0, 1}, {2, 3}, {4, 5}, {6, 7},
+    {2, 4}, {3, 5},
+    {1, 4}, {3, 6},
+    {1, 2}, {3, 4}, {5, 6}
+};
+
+
+int best_simd_isa(void) {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+        return SIMD_AVX512;
+    if (__builtin_cpu_supports("avx2"))
+        return SIMD_AVX2;
+    return SIMD_SCALAR;
+}
+
+
+/*
+ * Escalar (sem SIMD): ordenação por inserção dos blocos e fusão sem desvios
+ */
+
+static void insertion_sort(double *array, long int size) {
+    for (long int i = 1; i < size; i++) {
+        double value = array[i];
+        long int j = i - 1;
+        while (j >= 0 && array[j] > value) {
+            array[j + 1] = array[j];
+            j--;
+        }
+        array[j + 1] = value;
+    }
+}
+
+
+// A escolha entre a e b vira um cmov: não há desvio para o preditor errar
+static void merge_scalar(const double *a, long int na, const double *b, long int nb, double *output) {
+    long int i = 0, j = 0, k = 0;
+    while (i < na && j < nb) {
+        int take_a = a[i] <= b[j];
+        output[k++] = take_a ? a[i] : b[j];
+        i += take_a;
+        j += !take_a;
+    }
+    while (i < na) output[k++] = a[i++];
+    while (j < nb) output[k++] = b[j++];
+}
+
+
+// Depois da parte vetorial da fusão sobram os width elementos carregados
+// (carry) e o final das duas entradas; todos são >= ao que já foi escrito.
+static void merge_tail(const double *carry, int width, const double *a, long int na,
+                       const double *b, long int nb, double *output) {
+    arena_t *arena = thread_arena();
+    size_t mark = arena_mark(arena);
+    double *tmp = (double*)arena_alloc(arena, sizeof(double) * (width + na));
+    merge_scalar(carry, width, a, na, tmp);
+    merge_scalar(tmp, width + na, b, nb, output);
+    arena_reset(arena, mark);
+}
+
+
+/*
+ * AVX2: 4 doubles por registrador, blocos de 16
+ */
+
+static inline AVX2 __m256d reverse4(__m256d v) {
+    return _mm256_permute4x64_pd(v, 0x1B);
+}
+
+
+// Ordena um registrador bitônico: estágios de distância 2 e 1
+static inline AVX2 __m256d bitonic_clean4(__m256d v) {
+    __m256d t = _mm256_permute4x64_pd(v, 0x4E);
+    v = _mm256_blend_pd(_mm256_min_pd(v, t), _mm256_max_pd(v, t), 0xC);
+    t = _mm256_permute_pd(v, 0x5);
+    return _mm256_blend_pd(_mm256_min_pd(v, t), _mm256_max_pd(v, t), 0xA);
+}
+
+
+// v[0..n/2) e v[n/2..n) estão ordenados; ao final v[0..n) está ordenado.
+// A segunda metade é invertida para formar uma sequência bitônica.
+static AVX2 void bitonic_merge4(__m256d *v, int n) {
+    for (int i = n / 2; i < n; i++)
+        v[i] = reverse4(v[i]);
+    for (int i = 0; i < n / 4; i++) {
+        __m256d t = v[n / 2 + i];
+        v[n / 2 + i] = v[n - 1 - i];
+        v[n - 1 - i] = t;
+    }
+    for (int distance = n / 2; distance >= 1; distance /= 2) {
+        for (int i = 0; i < n; i++) {
+            if (i & distance)
+                continue;
+            __m256d low = _mm256_min_pd(v[i], v[i + distance]);
+            v[i + distance] = _mm256_max_pd(v[i], v[i + distance]);
+            v[i] = low;
+        }
+    }
+    for (int i = 0; i < n; i++)
+        v[i] = bitonic_clean4(v[i]);
+}
+
+
+static AVX2 void sort_block_avx2(double *block) {
+    __m256d v[4];
+    for (int i = 0; i < 4; i++)
+        v[i] = _mm256_loadu_pd(block + 4 * i);
+
+    // Rede entre registradores: cada lane fica ordenada de v[0] a v[3]
+    for (int c = 0; c < 5; c++) {
+        int i = network4[c][0], j = network4[c][1];
+        __m256d low = _mm256_min_pd(v[i], v[j]);
+        v[j] = _mm256_max_pd(v[i], v[j]);
+        v[i] = low;
+    }
+
+    // Transposição 4x4: cada registrador passa a ser uma lane ordenada
+    __m256d t0 = _mm256_unpacklo_pd(v[0], v[1]), t1 = _mm256_unpackhi_pd(v[0], v[1]);
+    __m256d t2 = _mm256_unpacklo_pd(v[2], v[3]), t3 = _mm256_unpackhi_pd(v[2], v[3]);
+    v[0] = _mm256_permute2f128_pd(t0, t2, 0x20);
+    v[1] = _mm256_permute2f128_pd(t1, t3, 0x20);
+    v[2] = _mm256_permute2f128_pd(t0, t2, 0x31);
+    v[3] = _mm256_permute2f128_pd(t1, t3, 0x31);
+
+    // Redes de fusão bitônica: 4 runs de 4 -> 2 de 8 -> 1 de 16
+    bitonic_merge4(&v[0], 2);
+    bitonic_merge4(&v[2], 2);
+    bitonic_merge4(&v[0], 4);
+
+    for (int i = 0; i < 4; i++)
+        _mm256_storeu_pd(block + 4 * i, v[i]);
+}
+
+
+// Fusão vetorial: a cada passo 4 elementos novos entram numa rede bitônica
+// 4+4 com os 4 maiores do passo anterior; os 4 menores saem. O único desvio
+// escolhe de qual entrada ler, uma vez a cada 4 elementos.
+static AVX2 void merge_avx2(const double *a, long int na, const double *b, long int nb, double *output) {
+    if (na < 4 || nb < 4) {
+        merge_scalar(a, na, b, nb, output);
+        return;
+    }
+    __m256d v[2] = { _mm256_loadu_pd(a), _mm256_loadu_pd(b) };
+    long int i = 4, j = 4, k = 0;
+    bitonic_merge4(v, 2);
+    _mm256_storeu_pd(output, v[0]);
+    k += 4;
+    while (i + 4 <= na && j + 4 <= nb) {
+        if (a[i] <= b[j]) {
+            v[0] = _mm256_loadu_pd(a + i);
+            i += 4;
+        } else {
+            v[0] = _mm256_loadu_pd(b + j);
+            j += 4;
+        }
+        bitonic_merge4(v, 2);
+        _mm256_storeu_pd(output + k, v[0]);
+        k += 4;
+    }
+    double carry[4];
+    _mm256_storeu_pd(carry, v[1]);
+    merge_tail(carry, 4, a + i, na - i, b + j, nb - j, output + k);
+}
+
+
+/*
+ * AVX-512: 8 doubles por registrador, blocos de 64
+ */
+
+static inline AVX512 __m512d reverse8(__m512d v) {
+    return _mm512_permutexvar_pd(_mm512_set_epi64(0, 1, 2, 3, 4, 5, 6, 7), v);
+}
+
+
+// Ordena um registrador bitônico: estágios de distância 4, 2 e 1
+static inline AVX512 __m512d bitonic_clean8(__m512d v) {
+    __m512d t = _mm512_shuffle_f64x2(v, v, 0x4E);
+    v = _mm512_mask_blend_pd(0xF0, _mm512_min_pd(v, t), _mm512_max_pd(v, t));
+    t = _mm512_permutex_pd(v, 0x4E);
+    v = _mm512_mask_blend_pd(0xCC, _mm512_min_pd(v, t), _mm512_max_pd(v, t));
+    t = _mm512_permute_pd(v, 0x55);
+    return _mm512_mask_blend_pd(0xAA, _mm512_min_pd(v, t), _mm512_max_pd(v, t));
+}
+
+
+static AVX512 void bitonic_merge8(__m512d *v, int n) {
+    for (int i = n / 2; i < n; i++)
+        v[i] = reverse8(v[i]);
+    for (int i = 0; i < n / 4; i++) {
+        __m512d t = v[n / 2 + i];
+        v[n / 2 + i] = v[n - 1 - i];
+        v[n - 1 - i] = t;
+    }
+    for (int distance = n / 2; distance >= 1; distance /= 2) {
+        for (int i = 0; i < n; i++) {
+            if (i & distance)
+                continue;
+            __m512d low = _mm512_min_pd(v[i], v[i + distance]);
+            v[i + distance] = _mm512_max_pd(v[i], v[i + distance]);
+            v[i] = low;
+        }
+    }
+    for (int i = 0; i < n; i++)
+        v[i] = bitonic_clean8(v[i]);
+}
+
+
+static AVX512 void sort_block_avx512(double *block) {
+    __m512d v[8];
+    for (int i = 0; i < 8; i++)
+        v[i] = _mm512_loadu_pd(block + 8 * i);
+
+    for (int c = 0; c < 19; c++) {
+        int i = network8[c][0], j = network8[c][1];
+        __m512d low = _mm512_min_pd(v[i], v[j]);
+        v[j] = _mm512_max_pd(v[i], v[j]);
+        v[i] = low;
+    }
+
+    // Transposição 8x8 em três estágios: pares, quartetos e metades
+    __m512d t[8], u[8];
+    for (int i = 0; i < 4; i++) {
+        t[2 * i] = _mm512_unpacklo_pd(v[2 * i], v[2 * i + 1]);
+        t[2 * i + 1] = _mm512_unpackhi_pd(v[2 * i], v[2 * i + 1]);
+    }
+    const __m512i even_pairs = _mm512_set_epi64(13, 12, 5, 4, 9, 8, 1, 0);
+    const __m512i odd_pairs = _mm512_set_epi64(15, 14, 7, 6, 11, 10, 3, 2);
+    for (int h = 0; h < 2; h++) {
+        u[4 * h + 0] = _mm512_permutex2var_pd(t[4 * h + 0], even_pairs, t[4 * h + 2]);
+        u[4 * h + 1] = _mm512_permutex2var_pd(t[4 * h + 1], even_pairs, t[4 * h + 3]);
+        u[4 * h + 2] = _mm512_permutex2var_pd(t[4 * h + 0], odd_pairs, t[4 * h + 2]);
+        u[4 * h + 3] = _mm512_permutex2var_pd(t[4 * h + 1], odd_pairs, t[4 * h + 3]);
+    }
+    const __m512i low_halves = _mm512_set_epi64(11, 10, 9, 8, 3, 2, 1, 0);
+    const __m512i high_halves = _mm512_set_epi64(15, 14, 13, 12, 7, 6, 5, 4);
+    for (int i = 0; i < 4; i++) {
+        v[i] = _mm512_permutex2var_pd(u[i], low_halves, u[4 + i]);
+        v[4 + i] = _mm512_permutex2var_pd(u[i], high_halves, u[4 + i]);
+    }
+
+    // 8 runs de 8 -> 4 de 16 -> 2 de 32 -> 1 de 64
+    for (int n = 2; n <= 8; n *= 2)
+        for (int i = 0; i < 8; i += n)
+            bitonic_merge8(&v[i], n);
+
+    for (int i = 0; i < 8; i++)
+        _mm512_storeu_pd(block + 8 * i, v[i]);
+}
+
+
+static AVX512 void merge_avx512(const double *a, long int na, const double *b, long int nb, double *output) {
+    if (na < 8 || nb < 8) {
+        merge_scalar(a, na, b, nb, output);
+        return;
+    }
+    __m512d v[2] = { _mm512_loadu_pd(a), _mm512_loadu_pd(b) };
+    long int i = 8, j = 8, k = 0;
+    bitonic_merge8(v, 2);
+    _mm512_storeu_pd(output, v[0]);
+    k += 8;
+    while (i + 8 <= na && j + 8 <= nb) {
+        if (a[i] <= b[j]) {
+            v[0] = _mm512_loadu_pd(a + i);
+            i += 8;
+        } else {
+            v[0] = _mm512_loadu_pd(b + j);
+            j += 8;
+        }
+        bitonic_merge8(v, 2);
+        _mm512_storeu_pd(output + k, v[0]);
+        k += 8;
+    }
+    double carry[8];
+    _mm512_storeu_pd(carry, v[1]);
+    merge_tail(carry, 8, a + i, na - i, b + j, nb - j, output + k);
+}
+
+
+int MergeSort_network(double *array, long int size, int isa) {
+    if (isa == SIMD_AUTO)
+        isa = best_simd_isa();
+    int block = (isa == SIMD_AVX512) ? 64 : 16;
+
+    // Caso base: blocos inteiros pela rede de ordenação, o resto por inserção
+    long int number_of_blocks = (size + block - 1) / block;
+    #pragma omp parallel for schedule(static)
+    for (long int b = 0; b < number_of_blocks; b++) {
+        double *start = array + b * block;
+        if ((b + 1) * block > size)
+            insertion_sort(start, size - b * block);
+        else if (isa == SIMD_AVX512)
+            sort_block_avx512(start);
+        else if (isa == SIMD_AVX2)
+            sort_block_avx2(start);
+        else
+            insertion_sort(start, block);
+    }
+
+    // Níveis de cima: fusões de pares de runs, de baixo para cima
+    double *buffer = (double*)allocate_aligned_memory(sizeof(double) * (size > 0 ? size : 1));
+    double *source = array, *destination = buffer;
+    for (long int width = block; width < size; width *= 2) {
+        #pragma omp parallel for schedule(dynamic)
+        for (long int left = 0; left < size; left += 2 * width) {
+            long int na = (left + width < size) ? width : size - left;
+            long int nb = (left + 2 * width < size) ? width : size - left - na;
+            if (isa == SIMD_AVX512)
+                merge_avx512(source + left, na, source + left + na, nb, destination + left);
+            else if (isa == SIMD_AVX2)
+                merge_avx2(source + left, na, source + left + na, nb, destination + left);
+            else
+                merge_scalar(source + left, na, source + left + na, nb, destination + left);
+        }
+        double *swap = source;
+        source = destination;
+        destination = swap;
+    }
+
+    if (source != array)
+        memcpy(array, source, sizeof(double) * size);
+    free_aligned_memory(buffer);
+    return isa;
+}
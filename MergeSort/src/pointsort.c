@@ -0,0 +1,139 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <float.h>
+#include <math.h>
+#include <libppc.h>
+#include <omp.h>
+
+#include "mergesort.h"
+
+// Bits por coordenada nas chaves das curvas: 2 * 26 = 52 bits cabem
+// exatamente na mantissa de um double, então a chave pode ser ordenada
+// pelo KeyValueSort sem perder nenhum bit.
+#define CURVE_BITS 26
+
+
+// Espalha os 32 bits de v nas posições pares de um inteiro de 64 bits
+static inline uint64_t spread_bits(uint32_t v) {
+    uint64_t x = v;
+    x = (x | (x << 16)) & 0x0000FFFF0000FFFFUL;
+    x = (x | (x << 8)) & 0x00FF00FF00FF00FFUL;
+    x = (x | (x << 4)) & 0x0F0F0F0F0F0F0F0FUL;
+    x = (x | (x << 2)) & 0x3333333333333333UL;
+    x = (x | (x << 1)) & 0x5555555555555555UL;
+    return x;
+}
+
+
+static inline uint64_t morton_key(uint32_t x, uint32_t y) {
+    return spread_bits(x) | (spread_bits(y) << 1);
+}
+
+
+// Posição de (x, y) na curva de Hilbert de uma grade 2^CURVE_BITS x
+// 2^CURVE_BITS: a cada nível o quadrante soma seu deslocamento e as
+// coordenadas são giradas/refletidas para a orientação do sub-quadrado.
+static inline uint64_t hilbert_key(uint32_t x, uint32_t y) {
+    const uint32_t n = 1U << CURVE_BITS;
+    uint64_t d = 0;
+    for (uint32_t s = n / 2; s > 0; s /= 2) {
+        uint32_t rx = (x & s) > 0, ry = (y & s) > 0;
+        d += (uint64_t)s * s * ((3 * rx) ^ ry);
+        if (ry == 0) {
+            if (rx == 1) {
+                x = n - 1 - x;
+                y = n - 1 - y;
+            }
+            uint32_t t = x;
+            x = y;
+            y = t;
+        }
+    }
+    return d;
+}
+
+
+// Coordenada na grade [0, 2^CURVE_BITS) da caixa envolvente
+static inline uint32_t quantize(double value, double minimum, double scale) {
+    return (uint32_t)((value - minimum) * scale);
+}
+
+
+// Ordena pairs pela chave e reescreve points na ordem dos índices
+static void sort_by_keys(point2D_t *points, key_value_t *pairs, point2D_t *copy, long int size) {
+    KeyValueSort_parallel(pairs, size);
+    #pragma omp parallel for schedule(static)
+    for (long int i = 0; i < size; i++)
+        points[i] = copy[pairs[i].value];
+}
+
+
+void PointSort_parallel(point2D_t *points, long int size, int order) {
+    if (size < 2)
+        return;
+
+    // A ordenação trabalha com pares (chave, índice) de 16 bytes; os pontos
+    // só são movidos uma vez, no final
+    key_value_t *pairs = (key_value_t*)allocate_aligned_memory(sizeof(key_value_t) * size);
+    point2D_t *copy = (point2D_t*)allocate_aligned_memory(sizeof(point2D_t) * size);
+    memcpy(copy, points, sizeof(point2D_t) * size);
+
+    if (order == POINT_ORDER_X || order == POINT_ORDER_XY) {
+        // (x, y) lexicográfico = ordenação estável por y seguida de
+        // ordenação estável por x
+        if (order == POINT_ORDER_XY) {
+            #pragma omp parallel for schedule(static)
+            for (long int i = 0; i < size; i++) {
+                pairs[i].key = points[i].y;
+                pairs[i].value = i;
+            }
+            sort_by_keys(points, pairs, copy, size);
+            memcpy(copy, points, sizeof(point2D_t) * size);
+        }
+        #pragma omp parallel for schedule(static)
+        for (long int i = 0; i < size; i++) {
+            pairs[i].key = points[i].x;
+            pairs[i].value = i;
+        }
+        sort_by_keys(points, pairs, copy, size);
+    } else {
+        double min_x = DBL_MAX, max_x = -DBL_MAX, min_y = DBL_MAX, max_y = -DBL_MAX;
+        #pragma omp parallel for schedule(static) reduction(min:min_x, min_y) reduction(max:max_x, max_y)
+        for (long int i = 0; i < size; i++) {
+            if (points[i].x < min_x) min_x = points[i].x;
+            if (points[i].x > max_x) max_x = points[i].x;
+            if (points[i].y < min_y) min_y = points[i].y;
+            if (points[i].y > max_y) max_y = points[i].y;
+        }
+        // Uma escala só para os dois eixos preserva as proporções da caixa;
+        // o maior valor cai na última célula, não fora da grade
+        double extent = (max_x - min_x > max_y - min_y) ? max_x - min_x : max_y - min_y;
+        double scale = (extent > 0) ? ((double)(1U << CURVE_BITS) - 1) / extent : 0;
+
+        #pragma omp parallel for schedule(static)
+        for (long int i = 0; i < size; i++) {
+            uint32_t x = quantize(points[i].x, min_x, scale);
+            uint32_t y = quantize(points[i].y, min_y, scale);
+            uint64_t key = (order == POINT_ORDER_MORTON) ? morton_key(x, y) : hilbert_key(x, y);
+            pairs[i].key = (double)key;
+            pairs[i].value = i;
+        }
+        sort_by_keys(points, pairs, copy, size);
+    }
+
+    free_aligned_memory(pairs);
+    free_aligned_memory(copy);
+}
+
+
+double mean_point_step(const point2D_t *points, long int size) {
+    double total = 0;
+    #pragma omp parallel for schedule(static) reduction(+:total)
+    for (long int i = 1; i < size; i++) {
+        double dx = points[i].x - points[i - 1].x, dy = points[i].y - points[i - 1].y;
+        total += sqrt(dx * dx + dy * dy);
+    }
+    return (size > 1) ? total / (size - 1) : 0;
+}
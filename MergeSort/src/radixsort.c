@@ -0,0 +1,188 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <libppc.h>
+#include <omp.h>
+
+#include "mergesort.h"
+
+// Dígitos de 8 bits: 256 baldes, histogramas cabem na L1
+#define RADIX_BITS 8
+#define RADIX_BUCKETS (1 << RADIX_BITS)
+
+// Elementos por buffer de write-combining: uma linha de cache (64 bytes)
+#define WC_DOUBLES 8
+#define WC_INTS 16
+
+
+// Chave sem sinal que preserva a ordem dos doubles IEEE-754: negativos têm
+// todos os bits invertidos, positivos só o bit de sinal. Todo NaN vira a
+// maior chave, então os NaN vão para o fim na ordem em que apareciam.
+static inline uint64_t double_to_key(double value) {
+    uint64_t bits;
+    if (isnan(value))
+        return UINT64_MAX;
+    memcpy(&bits, &value, sizeof(bits));
+    return (bits & 0x8000000000000000UL) ? ~bits : (bits | 0x8000000000000000UL);
+}
+
+
+static inline uint32_t int_to_key(int value) {
+    return (uint32_t)value ^ 0x80000000U;
+}
+
+
+// Converte os histogramas das threads em posições iniciais de escrita:
+// para cada dígito, as threads escrevem em ordem, o que mantém a
+// ordenação estável. Retorna 1 se todos os elementos têm o mesmo dígito
+// (a passada pode ser pulada).
+static int prefix_sum(long int *histograms, int threads, long int size) {
+    long int running = 0;
+    int skip = 0;
+    for (int d = 0; d < RADIX_BUCKETS; d++) {
+        long int bucket_total = 0;
+        for (int t = 0; t < threads; t++) {
+            long int count = histograms[t * RADIX_BUCKETS + d];
+            histograms[t * RADIX_BUCKETS + d] = running;
+            running += count;
+            bucket_total += count;
+        }
+        if (bucket_total == size)
+            skip = 1;
+    }
+    return skip;
+}
+
+
+void RadixSort_double(double *array, long int size) {
+    double *buffer = (double*)allocate_aligned_memory(sizeof(double) * (size > 0 ? size : 1));
+    int threads = omp_get_max_threads();
+    long int *histograms = (long int*)malloc(sizeof(long int) * RADIX_BUCKETS * threads);
+    double *result = array;
+
+    #pragma omp parallel num_threads(threads)
+    {
+        int t = omp_get_thread_num();
+        int team = omp_get_num_threads();
+        long int first = size * t / team, last = size * (t + 1) / team;
+        long int *offsets = &histograms[t * RADIX_BUCKETS];
+
+        // Buffers de write-combining: cada dígito acumula uma linha de cache
+        // antes de ir para a memória, em vez de 256 escritas espalhadas
+        double (*combining)[WC_DOUBLES] = (double (*)[WC_DOUBLES])
+            allocate_aligned_memory(sizeof(double) * WC_DOUBLES * RADIX_BUCKETS);
+        int fill[RADIX_BUCKETS];
+        double *source = array, *destination = buffer;
+
+        for (int shift = 0; shift < 64; shift += RADIX_BITS) {
+            memset(offsets, 0, sizeof(long int) * RADIX_BUCKETS);
+            for (long int i = first; i < last; i++)
+                offsets[(double_to_key(source[i]) >> shift) & (RADIX_BUCKETS - 1)]++;
+
+            int skip;
+            #pragma omp barrier
+            #pragma omp single copyprivate(skip)
+            skip = prefix_sum(histograms, team, size);
+            if (skip)
+                continue;
+
+            memset(fill, 0, sizeof(fill));
+            for (long int i = first; i < last; i++) {
+                int d = (double_to_key(source[i]) >> shift) & (RADIX_BUCKETS - 1);
+                combining[d][fill[d]++] = source[i];
+                if (fill[d] == WC_DOUBLES) {
+                    memcpy(&destination[offsets[d]], combining[d], sizeof(double) * WC_DOUBLES);
+                    offsets[d] += WC_DOUBLES;
+                    fill[d] = 0;
+                }
+            }
+            for (int d = 0; d < RADIX_BUCKETS; d++) {
+                memcpy(&destination[offsets[d]], combining[d], sizeof(double) * fill[d]);
+            }
+            // Ninguém lê a próxima passada antes de todos terminarem de escrever
+            #pragma omp barrier
+
+            double *swap = source;
+            source = destination;
+            destination = swap;
+        }
+
+        if (t == 0)
+            result = source;
+        free_aligned_memory(combining);
+    }
+
+    if (result != array) {
+        #pragma omp parallel for schedule(static)
+        for (long int i = 0; i < size; i++)
+            array[i] = result[i];
+    }
+    free(histograms);
+    free_aligned_memory(buffer);
+}
+
+
+void RadixSort_int(int *array, long int size) {
+    int *buffer = (int*)allocate_aligned_memory(sizeof(int) * (size > 0 ? size : 1));
+    int threads = omp_get_max_threads();
+    long int *histograms = (long int*)malloc(sizeof(long int) * RADIX_BUCKETS * threads);
+    int *result = array;
+
+    #pragma omp parallel num_threads(threads)
+    {
+        int t = omp_get_thread_num();
+        int team = omp_get_num_threads();
+        long int first = size * t / team, last = size * (t + 1) / team;
+        long int *offsets = &histograms[t * RADIX_BUCKETS];
+        int (*combining)[WC_INTS] = (int (*)[WC_INTS])
+            allocate_aligned_memory(sizeof(int) * WC_INTS * RADIX_BUCKETS);
+        int fill[RADIX_BUCKETS];
+        int *source = array, *destination = buffer;
+
+        for (int shift = 0; shift < 32; shift += RADIX_BITS) {
+            memset(offsets, 0, sizeof(long int) * RADIX_BUCKETS);
+            for (long int i = first; i < last; i++)
+                offsets[(int_to_key(source[i]) >> shift) & (RADIX_BUCKETS - 1)]++;
+
+            int skip;
+            #pragma omp barrier
+            #pragma omp single copyprivate(skip)
+            skip = prefix_sum(histograms, team, size);
+            if (skip)
+                continue;
+
+            memset(fill, 0, sizeof(fill));
+            for (long int i = first; i < last; i++) {
+                int d = (int_to_key(source[i]) >> shift) & (RADIX_BUCKETS - 1);
+                combining[d][fill[d]++] = source[i];
+                if (fill[d] == WC_INTS) {
+                    memcpy(&destination[offsets[d]], combining[d], sizeof(int) * WC_INTS);
+                    offsets[d] += WC_INTS;
+                    fill[d] = 0;
+                }
+            }
+            for (int d = 0; d < RADIX_BUCKETS; d++) {
+                memcpy(&destination[offsets[d]], combining[d], sizeof(int) * fill[d]);
+            }
+            #pragma omp barrier
+
+            int *swap = source;
+            source = destination;
+            destination = swap;
+        }
+
+        if (t == 0)
+            result = source;
+        free_aligned_memory(combining);
+    }
+
+    if (result != array) {
+        #pragma omp parallel for schedule(static)
+        for (long int i = 0; i < size; i++)
+            array[i] = result[i];
+    }
+    free(histograms);
+    free_aligned_memory(buffer);
+}
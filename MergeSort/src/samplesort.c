@@ -0,0 +1,135 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <libppc.h>
+#include <omp.h>
+
+#include "mergesort.h"
+
+// Semente fixa: a mesma entrada gera sempre os mesmos divisores
+#define SAMPLE_SEED 12345
+
+
+static int compare_doubles(const void *a, const void *b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+
+// Número de divisores <= value, isto é, o balde de value
+static inline int find_bucket(const double *splitters, int number_of_splitters, double value) {
+    int low = 0, high = number_of_splitters;
+    while (low < high) {
+        int middle = (low + high) / 2;
+        if (splitters[middle] <= value)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    return low;
+}
+
+
+void SampleSort_parallel(double *array, long int size, int oversampling,
+                         sample_sort_statistics_t *statistics) {
+    int threads = omp_get_max_threads();
+    int buckets = threads;
+    if (buckets > SAMPLE_SORT_MAX_BUCKETS)
+        buckets = SAMPLE_SORT_MAX_BUCKETS;
+    if (oversampling < 1)
+        oversampling = 1;
+    if (statistics != NULL)
+        memset(statistics, 0, sizeof(sample_sort_statistics_t));
+    if (size < 2 || buckets < 2) {
+        // Um único balde com o vetor inteiro, balanceado por definição
+        if (statistics != NULL) {
+            statistics->buckets = 1;
+            statistics->smallest_bucket = size;
+            statistics->largest_bucket = size;
+            statistics->imbalance = 1.0;
+        }
+        MergeSort_serial(array, 0, size - 1);
+        return;
+    }
+
+    // 1. Amostra de buckets * oversampling elementos; os divisores são
+    //    as amostras de posição oversampling, 2 * oversampling, ...
+    long int number_of_samples = (long int)buckets * oversampling;
+    double *samples = (double*)malloc(sizeof(double) * number_of_samples);
+    unsigned int seed = SAMPLE_SEED;
+    for (long int s = 0; s < number_of_samples; s++)
+        samples[s] = array[((unsigned long)rand_r(&seed) * RAND_MAX + rand_r(&seed)) % size];
+    qsort(samples, number_of_samples, sizeof(double), compare_doubles);
+    double splitters[SAMPLE_SORT_MAX_BUCKETS];
+    for (int b = 1; b < buckets; b++)
+        splitters[b - 1] = samples[(long int)b * oversampling];
+    free(samples);
+
+    // 2. Uma passada paralela classifica e conta; o balde de cada elemento
+    //    fica guardado para não repetir a busca binária na distribuição.
+    unsigned short *bucket_of = (unsigned short*)allocate_aligned_memory(sizeof(unsigned short) * size);
+    long int *offsets = (long int*)calloc((size_t)threads * buckets, sizeof(long int));
+    long int *bucket_start = (long int*)malloc(sizeof(long int) * (buckets + 1));
+    double *buffer = (double*)allocate_aligned_memory(sizeof(double) * size);
+
+    #pragma omp parallel num_threads(threads)
+    {
+        int t = omp_get_thread_num();
+        int team = omp_get_num_threads();
+        long int first = size * t / team, last = size * (t + 1) / team;
+        long int *my_offsets = &offsets[(long int)t * buckets];
+
+        for (long int i = first; i < last; i++) {
+            int b = find_bucket(splitters, buckets - 1, array[i]);
+            bucket_of[i] = (unsigned short)b;
+            my_offsets[b]++;
+        }
+
+        #pragma omp barrier
+        #pragma omp single
+        {
+            // Baldes em ordem e, dentro de cada balde, as threads em ordem
+            long int running = 0;
+            for (int b = 0; b < buckets; b++) {
+                bucket_start[b] = running;
+                for (int u = 0; u < team; u++) {
+                    long int count = offsets[(long int)u * buckets + b];
+                    offsets[(long int)u * buckets + b] = running;
+                    running += count;
+                }
+            }
+            bucket_start[buckets] = running;
+        }
+
+        for (long int i = first; i < last; i++)
+            buffer[my_offsets[bucket_of[i]]++] = array[i];
+
+        // 3. Baldes ordenados de forma independente e copiados de volta;
+        //    dynamic compensa baldes de tamanhos diferentes
+        #pragma omp barrier
+        #pragma omp for schedule(dynamic, 1)
+        for (int b = 0; b < buckets; b++) {
+            long int left = bucket_start[b], right = bucket_start[b + 1] - 1;
+            MergeSort_serial(buffer, left, right);
+            memcpy(&array[left], &buffer[left], sizeof(double) * (right - left + 1));
+        }
+    }
+
+    if (statistics != NULL) {
+        statistics->buckets = buckets;
+        statistics->smallest_bucket = size;
+        for (int b = 0; b < buckets; b++) {
+            long int length = bucket_start[b + 1] - bucket_start[b];
+            if (length < statistics->smallest_bucket)
+                statistics->smallest_bucket = length;
+            if (length > statistics->largest_bucket)
+                statistics->largest_bucket = length;
+        }
+        statistics->imbalance = statistics->largest_bucket / ((double)size / buckets);
+    }
+
+    free_aligned_memory(bucket_of);
+    free_aligned_memory(buffer);
+    free(offsets);
+    free(bucket_start);
+}
@@ -0,0 +1,221 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <libppc.h>
+#include <omp.h>
+
+#include "mergesort.h"
+
+// Abaixo disso a seleção paralela copia o vetor e usa a serial
+#define SELECT_SERIAL_CUTOFF 16384
+
+// Trechos maiores que isso são reduzidos por uma amostra recursiva
+// antes de particionar (Floyd-Rivest)
+#define FLOYD_RIVEST_CUTOFF 600
+
+#define SELECT_SEED 12345
+
+
+static inline void swap_doubles(double *a, double *b) {
+    double t = *a;
+    *a = *b;
+    *b = t;
+}
+
+
+// Floyd-Rivest: o pivô vem de uma seleção recursiva numa amostra em volta
+// da posição esperada de k, então cada partição descarta quase todo o
+// trecho e o número de comparações fica perto de N + min(k, N - k).
+static void floyd_rivest(double *array, long int left, long int right, long int k) {
+    while (right > left) {
+        if (right - left > FLOYD_RIVEST_CUTOFF) {
+            double n = right - left + 1, i = k - left + 1;
+            double z = log(n);
+            double s = 0.5 * exp(2.0 * z / 3.0);
+            double sd = 0.5 * sqrt(z * s * (n - s) / n) * (i < n / 2 ? -1 : 1);
+            long int new_left = (long int)(k - i * s / n + sd);
+            long int new_right = (long int)(k + (n - i) * s / n + sd);
+            floyd_rivest(array, new_left > left ? new_left : left,
+                         new_right < right ? new_right : right, k);
+        }
+
+        double pivot = array[k];
+        long int i = left, j = right;
+        swap_doubles(&array[left], &array[k]);
+        if (array[right] > pivot)
+            swap_doubles(&array[right], &array[left]);
+        while (i < j) {
+            swap_doubles(&array[i], &array[j]);
+            i++;
+            j--;
+            while (array[i] < pivot) i++;
+            while (array[j] > pivot) j--;
+        }
+        if (array[left] == pivot) {
+            swap_doubles(&array[left], &array[j]);
+        } else {
+            j++;
+            swap_doubles(&array[j], &array[right]);
+        }
+        if (j <= k) left = j + 1;
+        if (k <= j) right = j - 1;
+    }
+}
+
+
+double Select_serial(double *array, long int size, long int k) {
+    floyd_rivest(array, 0, size - 1, k);
+    return array[k];
+}
+
+
+// Seleção numa cópia: para os casos pequenos e para o fallback
+static double select_copy(const double *array, long int size, long int k) {
+    double *copy = (double*)allocate_aligned_memory(sizeof(double) * size);
+    memcpy(copy, array, sizeof(double) * size);
+    double value = Select_serial(copy, size, k);
+    free_aligned_memory(copy);
+    return value;
+}
+
+
+double Select_parallel(const double *array, long int size, long int k) {
+    if (size <= SELECT_SERIAL_CUTOFF || omp_get_max_threads() == 1)
+        return select_copy(array, size, k);
+
+    // 1. Amostra de ~N^(2/3) elementos; low e high ficam alguns desvios
+    //    padrão abaixo e acima da posição de k na amostra, então com alta
+    //    probabilidade o k-ésimo está em [low, high].
+    long int samples = (long int)pow((double)size, 2.0 / 3.0);
+    double *sample = (double*)malloc(sizeof(double) * samples);
+    unsigned int seed = SELECT_SEED;
+    for (long int s = 0; s < samples; s++)
+        sample[s] = array[((unsigned long)rand_r(&seed) * RAND_MAX + rand_r(&seed)) % size];
+    long int rank = (long int)((double)k * samples / size);
+    long int delta = (long int)(2.0 * sqrt((double)samples)) + 1;
+    double low = -INFINITY, high = INFINITY;
+    if (rank - delta >= 0)
+        low = Select_serial(sample, samples, rank - delta);
+    if (rank + delta < samples)
+        high = Select_serial(sample, samples, rank + delta);
+    free(sample);
+
+    // 2. Uma passada paralela conta os elementos abaixo de low e copia os
+    //    candidatos de [low, high] para um vetor pequeno
+    int threads = omp_get_max_threads();
+    long int *below = (long int*)calloc(threads, sizeof(long int));
+    long int *candidates = (long int*)calloc(threads + 1, sizeof(long int));
+    double *buffer = NULL;
+
+    #pragma omp parallel num_threads(threads)
+    {
+        int t = omp_get_thread_num();
+        int team = omp_get_num_threads();
+        long int first = size * t / team, last = size * (t + 1) / team;
+        for (long int i = first; i < last; i++) {
+            if (array[i] < low)
+                below[t]++;
+            else if (array[i] <= high)
+                candidates[t + 1]++;
+        }
+        #pragma omp barrier
+        #pragma omp single
+        {
+            for (int u = 0; u < team; u++)
+                candidates[u + 1] += candidates[u];
+            buffer = (double*)allocate_aligned_memory(sizeof(double) * (candidates[team] > 0 ? candidates[team] : 1));
+        }
+        long int position = candidates[t];
+        for (long int i = first; i < last; i++) {
+            if (array[i] >= low && array[i] <= high)
+                buffer[position++] = array[i];
+        }
+    }
+
+    long int number_below = 0;
+    for (int t = 0; t < threads; t++)
+        number_below += below[t];
+    long int number_of_candidates = candidates[threads];
+    double value;
+    if (k >= number_below && k < number_below + number_of_candidates) {
+        value = Select_serial(buffer, number_of_candidates, k - number_below);
+    } else {
+        // Amostra azarada: o k-ésimo ficou fora de [low, high]
+        value = select_copy(array, size, k);
+    }
+
+    free_aligned_memory(buffer);
+    free(below);
+    free(candidates);
+    return value;
+}
+
+
+// Max-heap dos k menores vistos até agora: a raiz é o maior deles
+static void heap_sift_down(double *heap, long int count, long int i) {
+    while (2 * i + 1 < count) {
+        long int child = 2 * i + 1;
+        if (child + 1 < count && heap[child + 1] > heap[child])
+            child++;
+        if (heap[i] >= heap[child])
+            return;
+        swap_doubles(&heap[i], &heap[child]);
+        i = child;
+    }
+}
+
+
+static void heap_push(double *heap, long int count, double value) {
+    long int i = count;
+    heap[i] = value;
+    while (i > 0 && heap[(i - 1) / 2] < heap[i]) {
+        swap_doubles(&heap[(i - 1) / 2], &heap[i]);
+        i = (i - 1) / 2;
+    }
+}
+
+
+void TopK_parallel(const double *array, long int size, long int k, double *output) {
+    if (k > size)
+        k = size;
+    if (k <= 0)
+        return;
+
+    // Cada thread mantém um heap com os k menores do seu trecho; no fim os
+    // heaps são juntados e os k menores deles são os k menores do vetor
+    int threads = omp_get_max_threads();
+    double *heaps = (double*)allocate_aligned_memory(sizeof(double) * k * threads);
+    long int *counts = (long int*)calloc(threads, sizeof(long int));
+
+    #pragma omp parallel num_threads(threads)
+    {
+        int t = omp_get_thread_num();
+        int team = omp_get_num_threads();
+        long int first = size * t / team, last = size * (t + 1) / team;
+        double *heap = &heaps[(long int)t * k];
+        long int count = 0;
+        for (long int i = first; i < last; i++) {
+            if (count < k) {
+                heap_push(heap, count++, array[i]);
+            } else if (array[i] < heap[0]) {
+                heap[0] = array[i];
+                heap_sift_down(heap, k, 0);
+            }
+        }
+        counts[t] = count;
+    }
+
+    long int total = 0;
+    for (int t = 0; t < threads; t++) {
+        memmove(&heaps[total], &heaps[(long int)t * k], sizeof(double) * counts[t]);
+        total += counts[t];
+    }
+    if (total > k)
+        Select_serial(heaps, total, k - 1);
+    MergeSort_serial(heaps, 0, k - 1);
+    memcpy(output, heaps, sizeof(double) * k);
+
+    free_aligned_memory(heaps);
+    free(counts);
+}
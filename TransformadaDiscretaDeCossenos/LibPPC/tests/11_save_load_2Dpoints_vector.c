@@ -0,0 +1,50 @@
+#include <libppc.h>
+
+#include <stdlib.h>
+
+#include <stdio.h>
+
+int main(){
+
+    point2D_t *v1 = generate_random_2Dpoints_vector( 10000, 0, 10 );
+
+    if ( save_2Dpoints_vector( v1, 10000, "points1.test.input" ) != 0 )
+        return 1;
+
+    point2D_t *v2 = load_2Dpoints_vector( "points1.test.input", 10000 );
+
+    if ( v2 == NULL )
+        return 2;
+
+    for ( long int i = 0; i < 10000; i++ ){
+
+        if ( v1[ i ].x != v2[ i ].x || v1[ i ].y != v2[ i ].y )
+            return 3;
+    }
+
+    save_2Dpoints_vector( v2, 10000, "points2.test.input" );
+
+    if ( ! compare_2Dpoints_vector_on_files( "points1.test.input", "points2.test.input" ) )
+        return 4;
+
+    // Only the y of the last point differs
+    v2[ 9999 ].y += 1.0;
+    save_2Dpoints_vector( v2, 10000, "points2.test.input" );
+
+    if ( compare_2Dpoints_vector_on_files( "points1.test.input", "points2.test.input" ) )
+        return 5;
+
+    // Fewer points on the second file
+    save_2Dpoints_vector( v1, 9999, "points2.test.input" );
+
+    if ( compare_2Dpoints_vector_on_files( "points1.test.input", "points2.test.input" ) )
+        return 6;
+
+    if ( load_2Dpoints_vector( "points2.test.input", 10000 ) != NULL )
+        return 7;
+
+    free( v1 );
+    free( v2 );
+
+    return 0;
+}
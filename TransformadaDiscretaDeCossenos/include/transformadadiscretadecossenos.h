@@ -0,0 +1,190 @@
+#ifndef __TRANSFORMADADISCRETADECOSSENOS_H__
+
+#define __TRANSFORMADADISCRETADECOSSENOS_H__
+
+#include <stddef.h>
+#include <libppc.h>
+
+#define PI 3.14159265358979323846
+
+/**
+	\brief DCT-II direta (O(N²)), ortonormal, com um cos da libm por termo
+*/
+void DCT1D_serial(const double *input, double *output, long int N);
+
+/**
+	\brief DCT1D_serial com as saídas output[k] divididas entre as threads
+*/
+void DCT1D_parallel(const double *input, double *output, long int N);
+
+// Conjuntos de instruções aceitos pelas variantes vetorizadas
+enum simd_isa_enum {
+	SIMD_AUTO = -1,
+	SIMD_SCALAR = 0,
+	SIMD_AVX2,
+	SIMD_AVX512
+};
+
+/**
+	\brief Melhor conjunto de instruções suportado pela CPU em que o programa roda
+*/
+int best_simd_isa(void);
+
+/**
+	\brief DCT direta com os cossenos gerados por recorrência
+
+	Para cada k, cos(π (n + 0.5) k / N) e o seno correspondente avançam de
+	n para n + 1 por uma rotação na forma estabilizada (c -= α c + β s,
+	s -= α s - β c, com α = 2 sin²(θ/2) e β = sin θ), que não perde
+	precisão quando θ é pequeno. A cada 128 termos os
+	valores são recalculados pela libm a partir de (2n + 1) k mod 4N, o que
+	limita o erro acumulado. Não usa tabela nenhuma: serve para N em que
+	uma tabela N x N não cabe na memória. As versões SIMD calculam 4 (AVX2)
+	ou 8 (AVX-512) saídas k vizinhas por passada sobre a entrada.
+
+	\param isa um valor de simd_isa_enum; SIMD_AUTO escolhe best_simd_isa()
+
+	\return o conjunto de instruções usado
+*/
+int DCT1D_recurrence(const double *input, double *output, long int N, int isa);
+
+/**
+	\brief DCT direta em blocos, com uma tabela de cossenos de tamanho O(N)
+
+	cos(π (2n + 1) k / 2N) só depende de (2n + 1) k mod 4N, então uma
+	tabela com um período (4N valores) substitui a matriz N x N e o índice
+	de cada termo sai do anterior com uma soma e uma subtração condicional.
+	A entrada é percorrida em blocos que cabem na L1 e cada bloco é usado
+	por todas as saídas da thread antes do próximo; as versões SIMD somam
+	4 (AVX2) ou 8 (AVX-512) saídas k vizinhas por passada, lendo a tabela
+	com gather.
+
+	\param isa um valor de simd_isa_enum; SIMD_AUTO escolhe best_simd_isa()
+
+	\return o conjunto de instruções usado
+*/
+int DCT1D_blocked(const double *input, double *output, long int N, int isa);
+
+/**
+	\brief DCT-II ortonormal em O(N log N) (Makhoul)
+
+	Os elementos pares em ordem seguidos dos ímpares de trás para frente
+	formam uma sequência cuja FFT complexa de tamanho N, girada por
+	exp(-πi k / 2N), tem X[k] como parte real. N = 2^a 3^b 5^c usa uma FFT
+	de radices mistas (4, 2, 3 e 5); os outros N usam o algoritmo de
+	Bluestein com uma FFT de tamanho M >= 2N - 1 potência de 2.
+
+	\return 0 em caso de sucesso, -1 se as tabelas não puderam ser alocadas
+*/
+int DCT1D_fast(const double *input, double *output, long int N);
+
+/**
+	\brief DCT-III ortonormal em O(N log N), a inversa de DCT1D_fast
+
+	\return 0 em caso de sucesso, -1 se as tabelas não puderam ser alocadas
+*/
+int IDCT1D_fast(const double *input, double *output, long int N);
+
+// Transformadas de um plano
+enum dct_type_enum {
+	DCT_TYPE_II = 2,
+	DCT_TYPE_III = 3
+};
+
+// Algoritmos de um plano
+enum dct_algorithm_enum {
+	DCT_ALGORITHM_AUTO = -1,
+	DCT_ALGORITHM_TABLE = 0,
+	DCT_ALGORITHM_FAST
+};
+
+typedef struct dct_plan dct_plan_t;
+
+/**
+	\brief Cria um plano para transformadas ortonormais de tamanho N
+
+	Tudo o que só depende de N fica pronto no plano e é reaproveitado em
+	cada execução: para DCT_ALGORITHM_FAST as tabelas de DCT1D_fast
+	(twiddles, inversão de dígitos, filtro de Bluestein, rotações e
+	escalas) e a memória de trabalho de cada thread; para
+	DCT_ALGORITHM_TABLE a matriz N x N de cossenos já escalados (N <= 1024).
+	DCT_ALGORITHM_AUTO mede os dois algoritmos com um vetor aleatório e
+	fica com o mais rápido.
+
+	\param type DCT_TYPE_II (direta) ou DCT_TYPE_III (inversa)
+	\param threads threads de dct_plan_execute_many
+
+	\return o plano, ou NULL se um parâmetro é inválido ou falta memória
+*/
+dct_plan_t *dct_plan_create(long int N, int type, int threads, int algorithm);
+
+/**
+	\brief Algoritmo escolhido pelo plano (um valor de dct_algorithm_enum)
+*/
+int dct_plan_algorithm(const dct_plan_t *plan);
+
+/**
+	\brief Uma transformada de N elementos
+
+	Usa a memória de trabalho da primeira thread: não pode ser chamada ao
+	mesmo tempo com o mesmo plano.
+*/
+void dct_plan_execute(const dct_plan_t *plan, const double *input, double *output);
+
+/**
+	\brief count transformadas de vetores contíguos de N elementos, divididas
+	entre as threads do plano
+*/
+void dct_plan_execute_many(const dct_plan_t *plan, const double *input, double *output, long int count);
+
+/**
+	\brief Libera o plano e tudo o que ele guarda
+*/
+void dct_plan_destroy(dct_plan_t *plan);
+
+/**
+	\brief DCT-II 2D ortonormal de uma matriz lines x columns em ordem de linhas
+
+	Decomposição linha-coluna: as linhas são transformadas em paralelo, a
+	matriz é transposta em blocos de 32 x 32, as colunas (agora linhas
+	contíguas) são transformadas em paralelo e o resultado é transposto de
+	volta. Cada dimensão usa o mesmo algoritmo de DCT1D_fast, com as tabelas
+	montadas uma vez e compartilhadas pelas threads.
+
+	\return 0 em caso de sucesso, -1 se as tabelas ou os buffers não puderam ser alocados
+*/
+int DCT2D_parallel(const double *input, double *output, long int lines, long int columns);
+
+/**
+	\brief DCT-III 2D ortonormal, a inversa de DCT2D_parallel
+
+	\return 0 em caso de sucesso, -1 se as tabelas ou os buffers não puderam ser alocados
+*/
+int IDCT2D_parallel(const double *input, double *output, long int lines, long int columns);
+
+/**
+	\brief DCT-II 2D ortonormal de cada bloco 8 x 8 de uma matriz (como no JPEG)
+
+	Cada bloco é transformado nas colunas e depois nas linhas pelo algoritmo
+	de Arai, Agui e Nakajima (5 multiplicações por transformada de 8 pontos),
+	com a escala de cada coeficiente aplicada uma vez no fim. Na versão
+	AVX-512 cada linha do bloco é um vetor e uma passada transforma as 8
+	colunas juntas; a AVX2 usa dois vetores por linha; a troca de linhas por
+	colunas é uma transposta nos registradores. As linhas de blocos são
+	divididas entre as threads. input e output podem ser o mesmo vetor.
+
+	\param lines, columns múltiplos de 8
+	\param isa um valor de simd_isa_enum; SIMD_AUTO escolhe best_simd_isa()
+
+	\return o conjunto de instruções usado, -1 se lines ou columns não é múltiplo de 8
+*/
+int DCT8x8_forward(const double *input, double *output, long int lines, long int columns, int isa);
+
+/**
+	\brief DCT-III 2D ortonormal de cada bloco 8 x 8, a inversa de DCT8x8_forward
+
+	\return o conjunto de instruções usado, -1 se lines ou columns não é múltiplo de 8
+*/
+int DCT8x8_inverse(const double *input, double *output, long int lines, long int columns, int isa);
+
+#endif
@@ -0,0 +1,272 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <immintrin.h>
+#include <libppc.h>
+#include <omp.h>
+
+#include "transformadadiscretadecossenos.h"
+
+// Mesmos atributos de recurrence.c
+#define AVX2 __attribute__((target("avx2,fma"), optimize("O2")))
+#define AVX512 __attribute__((target("avx512f"), optimize("O2")))
+
+// Constantes do AAN (as mesmas do jfdctflt/jidctflt da libjpeg)
+#define AAN_C4 0.707106781186547524     // cos(4π/16)
+#define AAN_C6 0.382683432365089772     // cos(6π/16)
+#define AAN_C2_C6 0.541196100146196984  // √2 cos(6π/16)
+#define AAN_C2C6 1.306562964876376527   // √2 cos(2π/16)
+#define AAN_SQRT2 1.414213562373095049
+#define AAN_2C2 1.847759065022573512    // 2 cos(2π/16)
+#define AAN_2C2_2C6 1.082392200292393968  // 2 (cos(2π/16) - cos(6π/16))
+#define AAN_2C2__2C6 2.613125929752753055 // 2 (cos(2π/16) + cos(6π/16))
+
+// DCT-II de 8 pontos de Arai, Agui e Nakajima sobre d[0..7], no lugar: 5
+// multiplicações e 29 somas. A saída k sai multiplicada por √8 aan(k),
+// com aan(0) = 1 e aan(k) = √2 cos(kπ/16); a correção vai junto com a
+// escala ortonormal, uma multiplicação por coeficiente no fim do bloco.
+// T, ADD, SUB, MUL e SET1 são o tipo e as operações (escalar ou vetor).
+#define AAN_FORWARD(d, T, ADD, SUB, MUL, SET1) do {                        \
+    T t0 = ADD(d[0], d[7]), t7 = SUB(d[0], d[7]);                          \
+    T t1 = ADD(d[1], d[6]), t6 = SUB(d[1], d[6]);                          \
+    T t2 = ADD(d[2], d[5]), t5 = SUB(d[2], d[5]);                          \
+    T t3 = ADD(d[3], d[4]), t4 = SUB(d[3], d[4]);                          \
+    T t10 = ADD(t0, t3), t13 = SUB(t0, t3);                                \
+    T t11 = ADD(t1, t2), t12 = SUB(t1, t2);                                \
+    d[0] = ADD(t10, t11);                                                  \
+    d[4] = SUB(t10, t11);                                                  \
+    T z1 = MUL(ADD(t12, t13), SET1(AAN_C4));                               \
+    d[2] = ADD(t13, z1);                                                   \
+    d[6] = SUB(t13, z1);                                                   \
+    t10 = ADD(t4, t5);                                                     \
+    t11 = ADD(t5, t6);                                                     \
+    t12 = ADD(t6, t7);                                                     \
+    T z5 = MUL(SUB(t10, t12), SET1(AAN_C6));                               \
+    T z2 = ADD(MUL(t10, SET1(AAN_C2_C6)), z5);                             \
+    T z4 = ADD(MUL(t12, SET1(AAN_C2C6)), z5);                              \
+    T z3 = MUL(t11, SET1(AAN_C4));                                         \
+    T z11 = ADD(t7, z3), z13 = SUB(t7, z3);                                \
+    d[5] = ADD(z13, z2);                                                   \
+    d[3] = SUB(z13, z2);                                                   \
+    d[1] = ADD(z11, z4);                                                   \
+    d[7] = SUB(z11, z4);                                                   \
+} while (0)
+
+// DCT-III de 8 pontos do AAN, a transposta de AAN_FORWARD: espera a
+// entrada k já multiplicada por aan(k) / √8
+#define AAN_INVERSE(d, T, ADD, SUB, MUL, SET1) do {                        \
+    T t10 = ADD(d[0], d[4]), t11 = SUB(d[0], d[4]);                        \
+    T t13 = ADD(d[2], d[6]);                                               \
+    T t12 = SUB(MUL(SUB(d[2], d[6]), SET1(AAN_SQRT2)), t13);               \
+    T e0 = ADD(t10, t13), e3 = SUB(t10, t13);                              \
+    T e1 = ADD(t11, t12), e2 = SUB(t11, t12);                              \
+    T z13 = ADD(d[5], d[3]), z10 = SUB(d[5], d[3]);                        \
+    T z11 = ADD(d[1], d[7]), z12 = SUB(d[1], d[7]);                        \
+    T o7 = ADD(z11, z13);                                                  \
+    T o11 = MUL(SUB(z11, z13), SET1(AAN_SQRT2));                           \
+    T z5 = MUL(ADD(z10, z12), SET1(AAN_2C2));                              \
+    T o10 = SUB(MUL(z12, SET1(AAN_2C2_2C6)), z5);                          \
+    T o12 = SUB(z5, MUL(z10, SET1(AAN_2C2__2C6)));                         \
+    T o6 = SUB(o12, o7);                                                   \
+    T o5 = SUB(o11, o6);                                                   \
+    T o4 = ADD(o10, o5);                                                   \
+    d[0] = ADD(e0, o7);                                                    \
+    d[7] = SUB(e0, o7);                                                    \
+    d[1] = ADD(e1, o6);                                                    \
+    d[6] = SUB(e1, o6);                                                    \
+    d[2] = ADD(e2, o5);                                                    \
+    d[5] = SUB(e2, o5);                                                    \
+    d[4] = ADD(e3, o4);                                                    \
+    d[3] = SUB(e3, o4);                                                    \
+} while (0)
+
+#define SCALAR_ADD(a, b) ((a) + (b))
+#define SCALAR_SUB(a, b) ((a) - (b))
+#define SCALAR_MUL(a, b) ((a) * (b))
+#define SCALAR_SET1(a) (a)
+
+// Transforma o bloco 8 x 8 em block (passo columns entre linhas), no lugar
+// de output; scale é multiplicado na saída (direta) ou na entrada (inversa)
+typedef void (*block8x8_kernel_t)(const double *block, double *output, long int columns,
+                                  const double *scale, int inverse);
+
+
+static void block8x8_scalar(const double *block, double *output, long int columns,
+                            const double *scale, int inverse) {
+    double tile[64], d[8];
+    for (int i = 0; i < 8; i++)
+        for (int j = 0; j < 8; j++)
+            tile[i * 8 + j] = inverse ? M(i, j, columns, block) * scale[i * 8 + j] : M(i, j, columns, block);
+    // Colunas e depois linhas
+    for (int j = 0; j < 8; j++) {
+        for (int i = 0; i < 8; i++)
+            d[i] = tile[i * 8 + j];
+        if (inverse)
+            AAN_INVERSE(d, double, SCALAR_ADD, SCALAR_SUB, SCALAR_MUL, SCALAR_SET1);
+        else
+            AAN_FORWARD(d, double, SCALAR_ADD, SCALAR_SUB, SCALAR_MUL, SCALAR_SET1);
+        for (int i = 0; i < 8; i++)
+            tile[i * 8 + j] = d[i];
+    }
+    for (int i = 0; i < 8; i++) {
+        double *row = &tile[i * 8];
+        if (inverse)
+            AAN_INVERSE(row, double, SCALAR_ADD, SCALAR_SUB, SCALAR_MUL, SCALAR_SET1);
+        else
+            AAN_FORWARD(row, double, SCALAR_ADD, SCALAR_SUB, SCALAR_MUL, SCALAR_SET1);
+        for (int j = 0; j < 8; j++)
+            M(i, j, columns, output) = inverse ? row[j] : row[j] * scale[i * 8 + j];
+    }
+}
+
+
+// Transposta de 4 x 4 em r[0..3]
+static inline AVX2 void transpose4_avx2(__m256d *r) {
+    __m256d t0 = _mm256_unpacklo_pd(r[0], r[1]), t1 = _mm256_unpackhi_pd(r[0], r[1]);
+    __m256d t2 = _mm256_unpacklo_pd(r[2], r[3]), t3 = _mm256_unpackhi_pd(r[2], r[3]);
+    r[0] = _mm256_permute2f128_pd(t0, t2, 0x20);
+    r[1] = _mm256_permute2f128_pd(t1, t3, 0x20);
+    r[2] = _mm256_permute2f128_pd(t0, t2, 0x31);
+    r[3] = _mm256_permute2f128_pd(t1, t3, 0x31);
+}
+
+
+// Transposta do bloco guardado como metades esquerda (low) e direita (high)
+// de cada linha: transpõe os quatro quadrantes 4 x 4 e troca os de fora
+// da diagonal
+static inline AVX2 void transpose8_avx2(__m256d *low, __m256d *high) {
+    transpose4_avx2(&low[0]);
+    transpose4_avx2(&low[4]);
+    transpose4_avx2(&high[0]);
+    transpose4_avx2(&high[4]);
+    for (int i = 0; i < 4; i++) {
+        __m256d t = high[i];
+        high[i] = low[4 + i];
+        low[4 + i] = t;
+    }
+}
+
+
+// Uma linha do bloco são dois vetores de 4 colunas: cada passada do AAN
+// transforma 4 colunas de uma vez; as linhas viram colunas pela transposta
+static AVX2 void block8x8_avx2(const double *block, double *output, long int columns,
+                               const double *scale, int inverse) {
+    __m256d low[8], high[8];
+    for (int i = 0; i < 8; i++) {
+        low[i] = _mm256_loadu_pd(&M(i, 0, columns, block));
+        high[i] = _mm256_loadu_pd(&M(i, 4, columns, block));
+        if (inverse) {
+            low[i] = _mm256_mul_pd(low[i], _mm256_loadu_pd(&scale[i * 8]));
+            high[i] = _mm256_mul_pd(high[i], _mm256_loadu_pd(&scale[i * 8 + 4]));
+        }
+    }
+    for (int pass = 0; pass < 2; pass++) {
+        if (inverse) {
+            AAN_INVERSE(low, __m256d, _mm256_add_pd, _mm256_sub_pd, _mm256_mul_pd, _mm256_set1_pd);
+            AAN_INVERSE(high, __m256d, _mm256_add_pd, _mm256_sub_pd, _mm256_mul_pd, _mm256_set1_pd);
+        } else {
+            AAN_FORWARD(low, __m256d, _mm256_add_pd, _mm256_sub_pd, _mm256_mul_pd, _mm256_set1_pd);
+            AAN_FORWARD(high, __m256d, _mm256_add_pd, _mm256_sub_pd, _mm256_mul_pd, _mm256_set1_pd);
+        }
+        transpose8_avx2(low, high);
+    }
+    for (int i = 0; i < 8; i++) {
+        if (!inverse) {
+            low[i] = _mm256_mul_pd(low[i], _mm256_loadu_pd(&scale[i * 8]));
+            high[i] = _mm256_mul_pd(high[i], _mm256_loadu_pd(&scale[i * 8 + 4]));
+        }
+        _mm256_storeu_pd(&M(i, 0, columns, output), low[i]);
+        _mm256_storeu_pd(&M(i, 4, columns, output), high[i]);
+    }
+}
+
+
+// Transposta de 8 x 8: pares de linhas, depois pares de 128 bits, depois
+// metades
+static inline AVX512 void transpose8_avx512(__m512d *r) {
+    __m512d t[8], s[8];
+    for (int i = 0; i < 4; i++) {
+        t[2 * i] = _mm512_unpacklo_pd(r[2 * i], r[2 * i + 1]);
+        t[2 * i + 1] = _mm512_unpackhi_pd(r[2 * i], r[2 * i + 1]);
+    }
+    for (int h = 0; h < 2; h++) {
+        s[4 * h + 0] = _mm512_shuffle_f64x2(t[4 * h + 0], t[4 * h + 2], 0x88);
+        s[4 * h + 1] = _mm512_shuffle_f64x2(t[4 * h + 0], t[4 * h + 2], 0xDD);
+        s[4 * h + 2] = _mm512_shuffle_f64x2(t[4 * h + 1], t[4 * h + 3], 0x88);
+        s[4 * h + 3] = _mm512_shuffle_f64x2(t[4 * h + 1], t[4 * h + 3], 0xDD);
+    }
+    r[0] = _mm512_shuffle_f64x2(s[0], s[4], 0x88);
+    r[4] = _mm512_shuffle_f64x2(s[0], s[4], 0xDD);
+    r[2] = _mm512_shuffle_f64x2(s[1], s[5], 0x88);
+    r[6] = _mm512_shuffle_f64x2(s[1], s[5], 0xDD);
+    r[1] = _mm512_shuffle_f64x2(s[2], s[6], 0x88);
+    r[5] = _mm512_shuffle_f64x2(s[2], s[6], 0xDD);
+    r[3] = _mm512_shuffle_f64x2(s[3], s[7], 0x88);
+    r[7] = _mm512_shuffle_f64x2(s[3], s[7], 0xDD);
+}
+
+
+// Uma linha do bloco por vetor: as 8 colunas numa passada
+static AVX512 void block8x8_avx512(const double *block, double *output, long int columns,
+                                   const double *scale, int inverse) {
+    __m512d r[8];
+    for (int i = 0; i < 8; i++) {
+        r[i] = _mm512_loadu_pd(&M(i, 0, columns, block));
+        if (inverse)
+            r[i] = _mm512_mul_pd(r[i], _mm512_loadu_pd(&scale[i * 8]));
+    }
+    for (int pass = 0; pass < 2; pass++) {
+        if (inverse)
+            AAN_INVERSE(r, __m512d, _mm512_add_pd, _mm512_sub_pd, _mm512_mul_pd, _mm512_set1_pd);
+        else
+            AAN_FORWARD(r, __m512d, _mm512_add_pd, _mm512_sub_pd, _mm512_mul_pd, _mm512_set1_pd);
+        transpose8_avx512(r);
+    }
+    for (int i = 0; i < 8; i++) {
+        if (!inverse)
+            r[i] = _mm512_mul_pd(r[i], _mm512_loadu_pd(&scale[i * 8]));
+        _mm512_storeu_pd(&M(i, 0, columns, output), r[i]);
+    }
+}
+
+
+static int transform_blocks(const double *input, double *output, long int lines, long int columns,
+                            int isa, int inverse) {
+    if (lines % 8 != 0 || columns % 8 != 0)
+        return -1;
+    if (isa == SIMD_AUTO)
+        isa = best_simd_isa();
+    block8x8_kernel_t kernel = block8x8_scalar;
+    if (isa == SIMD_AVX512)
+        kernel = block8x8_avx512;
+    else if (isa == SIMD_AVX2)
+        kernel = block8x8_avx2;
+
+    // Direta: X(u, v) = saída / (8 aan(u) aan(v)); inversa: entrada vezes
+    // aan(u) aan(v) / 8
+    double aan[8], scale[64];
+    for (int k = 0; k < 8; k++)
+        aan[k] = (k == 0) ? 1.0 : sqrt(2.0) * cos(k * PI / 16.0);
+    for (int u = 0; u < 8; u++)
+        for (int v = 0; v < 8; v++)
+            scale[u * 8 + v] = inverse ? aan[u] * aan[v] / 8.0 : 1.0 / (8.0 * aan[u] * aan[v]);
+
+    // Uma linha de blocos por iteração: as 8 linhas da matriz que ela cobre
+    // ficam com a mesma thread
+    #pragma omp parallel for schedule(static)
+    for (long int i = 0; i < lines; i += 8) {
+        for (long int j = 0; j < columns; j += 8)
+            kernel(&M(i, j, columns, input), &M(i, j, columns, output), columns, scale, inverse);
+    }
+    return isa;
+}
+
+
+int DCT8x8_forward(const double *input, double *output, long int lines, long int columns, int isa) {
+    return transform_blocks(input, output, lines, columns, isa, 0);
+}
+
+
+int DCT8x8_inverse(const double *input, double *output, long int lines, long int columns, int isa) {
+    return transform_blocks(input, output, lines, columns, isa, 1);
+}
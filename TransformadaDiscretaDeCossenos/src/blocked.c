@@ -0,0 +1,135 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <immintrin.h>
+#include <libppc.h>
+#include <omp.h>
+
+#include "transformadadiscretadecossenos.h"
+
+// Mesmos atributos de recurrence.c
+#define AVX2 __attribute__((target("avx2,fma"), optimize("O2")))
+#define AVX512 __attribute__((target("avx512f"), optimize("O2")))
+
+// Elementos da entrada por bloco: 8 KB, que ficam na L1 enquanto todas as
+// saídas de uma thread passam por eles
+#define DCT_INPUT_BLOCK 1024
+
+// Soma em output[k0..k0 + largura) os termos n0..n1 - 1 de largura saídas vizinhas
+typedef void (*blocked_kernel_t)(const double *input, const double *table, double *output,
+                                 long int N, long int k0, long int n0, long int n1);
+
+
+// cos(π (2n + 1) k / 2N) = table[(2n + 1) k mod 4N]: de n para n + 1 o
+// índice anda 2k (< 4N) e volta ao início com uma subtração
+static void block_scalar(const double *input, const double *table, double *output,
+                         long int N, long int k0, long int n0, long int n1) {
+    long int period = 4 * N, step = 2 * k0;
+    long int m = (2 * n0 + 1) * k0 % period;
+    double sum = output[k0];
+    for (long int n = n0; n < n1; n++) {
+        sum += input[n] * table[m];
+        m += step;
+        if (m >= period)
+            m -= period;
+    }
+    output[k0] = sum;
+}
+
+
+// 4 saídas por passada: um índice da tabela por lane, lido com gather
+static AVX2 void block_avx2(const double *input, const double *table, double *output,
+                            long int N, long int k0, long int n0, long int n1) {
+    long int period = 4 * N, first[4];
+    for (int lane = 0; lane < 4; lane++)
+        first[lane] = (2 * n0 + 1) * (k0 + lane) % period;
+    __m256i m = _mm256_loadu_si256((const __m256i*)first);
+    __m256i step = _mm256_set_epi64x(2 * (k0 + 3), 2 * (k0 + 2), 2 * (k0 + 1), 2 * k0);
+    __m256i limit = _mm256_set1_epi64x(period);
+    __m256d sum = _mm256_loadu_pd(&output[k0]);
+    for (long int n = n0; n < n1; n++) {
+        __m256d basis = _mm256_i64gather_pd(table, m, 8);
+        sum = _mm256_fmadd_pd(_mm256_broadcast_sd(&input[n]), basis, sum);
+        m = _mm256_add_epi64(m, step);
+        __m256i inside = _mm256_cmpgt_epi64(limit, m);
+        m = _mm256_sub_epi64(m, _mm256_andnot_si256(inside, limit));
+    }
+    _mm256_storeu_pd(&output[k0], sum);
+}
+
+
+// 8 saídas por passada
+static AVX512 void block_avx512(const double *input, const double *table, double *output,
+                                long int N, long int k0, long int n0, long int n1) {
+    long int period = 4 * N, first[8];
+    for (int lane = 0; lane < 8; lane++)
+        first[lane] = (2 * n0 + 1) * (k0 + lane) % period;
+    __m512i m = _mm512_loadu_si512(first);
+    __m512i step = _mm512_slli_epi64(_mm512_add_epi64(_mm512_set1_epi64(k0),
+                                     _mm512_set_epi64(7, 6, 5, 4, 3, 2, 1, 0)), 1);
+    __m512i limit = _mm512_set1_epi64(period);
+    __m512d sum = _mm512_loadu_pd(&output[k0]);
+    for (long int n = n0; n < n1; n++) {
+        __m512d basis = _mm512_i64gather_pd(m, table, 8);
+        sum = _mm512_fmadd_pd(_mm512_set1_pd(input[n]), basis, sum);
+        m = _mm512_add_epi64(m, step);
+        m = _mm512_mask_sub_epi64(m, _mm512_cmpge_epi64_mask(m, limit), m, limit);
+    }
+    _mm512_storeu_pd(&output[k0], sum);
+}
+
+
+int DCT1D_blocked(const double *input, double *output, long int N, int isa) {
+    if (isa == SIMD_AUTO)
+        isa = best_simd_isa();
+    blocked_kernel_t kernel = block_scalar;
+    long int width = 1;
+    if (isa == SIMD_AVX512) {
+        kernel = block_avx512;
+        width = 8;
+    } else if (isa == SIMD_AVX2) {
+        kernel = block_avx2;
+        width = 4;
+    }
+    if (N < 1)
+        return isa;
+
+    // Um período inteiro de cos(π m / 2N): 4N valores em vez de N x N
+    double *table = (double*)allocate_aligned_memory(sizeof(double) * 4 * N);
+    #pragma omp parallel for schedule(static)
+    for (long int m = 0; m < 4 * N; m++)
+        table[m] = cos(PI * m / (2.0 * N));
+
+    // Cada thread fica com um trecho fixo de saídas (grupos de width) e
+    // passa por todos os blocos da entrada; cada bloco é usado por todas
+    // as saídas da thread antes do próximo. As últimas N % width saídas
+    // usam o kernel escalar.
+    long int groups = N / width;
+    #pragma omp parallel
+    {
+        int t = omp_get_thread_num();
+        int threads = omp_get_num_threads();
+        long int g0 = (groups + 1) * t / threads, g1 = (groups + 1) * (t + 1) / threads;
+        long int k_first = g0 * width, k_last = (g1 * width < N) ? g1 * width : N;
+        for (long int k = k_first; k < k_last; k++)
+            output[k] = 0.0;
+
+        for (long int n0 = 0; n0 < N; n0 += DCT_INPUT_BLOCK) {
+            long int n1 = (n0 + DCT_INPUT_BLOCK < N) ? n0 + DCT_INPUT_BLOCK : N;
+            for (long int g = g0; g < g1; g++) {
+                if (g < groups) {
+                    kernel(input, table, output, N, g * width, n0, n1);
+                } else {
+                    for (long int k = g * width; k < N; k++)
+                        block_scalar(input, table, output, N, k, n0, n1);
+                }
+            }
+        }
+
+        for (long int k = k_first; k < k_last; k++)
+            output[k] *= (k == 0) ? sqrt(1.0 / N) : sqrt(2.0 / N);
+    }
+
+    free_aligned_memory(table);
+    return isa;
+}
@@ -0,0 +1,560 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <complex.h>
+#include <libppc.h>
+#include <omp.h>
+
+#include "transformadadiscretadecossenos.h"
+
+// Maior N de uma tabela N x N: 8 MB
+#define DCT_PLAN_TABLE_LIMIT 1024
+
+// Execuções de cada algoritmo na escolha medida; vale a menor
+#define DCT_PLAN_MEASUREMENTS 5
+
+// Lado dos blocos da transposição: 32 x 32 doubles = 8 KB de origem e 8 KB
+// de destino, os dois na L1
+#define TRANSPOSE_TILE 32
+
+
+// Maior número de fatores de uma FFT: 2^63 tem 63
+#define FFT_MAX_FACTORS 64
+
+
+// FFT iterativa de decimação no tempo de tamanho n = r_1 r_2 ... r_m, com
+// radices 4, 2, 3 e 5. A entrada é permutada pela inversão de dígitos (a
+// inversão de bits quando todos os fatores são 2 ou 4) e cada estágio
+// combina r sub-transformadas vizinhas.
+typedef struct {
+    long int n;
+    int factor_count;
+    int factors[FFT_MAX_FACTORS];
+    long int *digit_reversal;
+    double complex *twiddles;  // exp(-2πi j / n), j < n
+} fft_t;
+// DCT-II/III de tamanho N pelo algoritmo de Makhoul: uma FFT complexa de
+// tamanho N sobre a entrada reordenada. Para N com fatores primos maiores
+// que 5 a FFT é feita pelo algoritmo de Bluestein, com uma FFT de tamanho
+// M >= 2N - 1 potência de 2.
+typedef struct {
+    long int N;
+    int bluestein;
+    fft_t fft;
+    double complex *chirp;     // exp(-πi j² / N), Bluestein
+    double complex *filter;    // FFT do filtro conj(chirp), Bluestein
+    double complex *rotation;  // exp(-πi k / 2N)
+    double *scale;             // sqrt(1/N) para k = 0, sqrt(2/N) para os outros
+} dct_engine_t;
+
+// Memória de trabalho de uma thread
+typedef struct {
+    double complex *v;          // N
+    double complex *work;       // tamanho da FFT: a convolução de Bluestein
+    double complex *fft_work;   // tamanho da FFT: a entrada permutada
+} dct_scratch_t;
+
+
+// Decompõe n em 4, 2, 3 e 5; retorna -1 se sobra outro fator primo
+static int fft_factor(long int n, int *factors) {
+    static const int radices[] = {4, 2, 3, 5};
+    int count = 0;
+    for (int r = 0; r < 4; r++) {
+        while (n % radices[r] == 0) {
+            factors[count++] = radices[r];
+            n /= radices[r];
+        }
+    }
+    return (n == 1) ? count : -1;
+}
+
+
+static int fft_create(fft_t *fft, long int n) {
+    fft->n = n;
+    fft->factor_count = fft_factor(n, fft->factors);
+    fft->digit_reversal = (long int*)malloc(sizeof(long int) * n);
+    fft->twiddles = (double complex*)malloc(sizeof(double complex) * n);
+    if (fft->factor_count < 0 || fft->digit_reversal == NULL || fft->twiddles == NULL)
+        return -1;
+    // A posição p = d_1 + r_1 (d_2 + r_2 (...)) recebe a entrada
+    // d_1 n / r_1 + d_2 n / (r_1 r_2) + ...
+    for (long int p = 0; p < n; p++) {
+        long int rest = p, index = 0, span = n;
+        for (int f = 0; f < fft->factor_count; f++) {
+            span /= fft->factors[f];
+            index += (rest % fft->factors[f]) * span;
+            rest /= fft->factors[f];
+        }
+        fft->digit_reversal[p] = index;
+    }
+    for (long int j = 0; j < n; j++)
+        fft->twiddles[j] = cexp(-2.0 * PI * I * (double)j / n);
+    return 0;
+}
+
+
+static void fft_destroy(fft_t *fft) {
+    free(fft->digit_reversal);
+    free(fft->twiddles);
+}
+
+
+// FFT direta; a inversa (sem o 1/n) é conj(FFT(conj(x))). work tem n
+// elementos e recebe a entrada permutada; o resultado volta para data.
+static void fft_execute(const fft_t *fft, double complex *data, double complex *work) {
+    long int n = fft->n;
+    for (long int p = 0; p < n; p++)
+        work[p] = data[fft->digit_reversal[p]];
+
+    long int previous = 1;
+    for (int f = 0; f < fft->factor_count; f++) {
+        int r = fft->factors[f];
+        long int length = previous * r, stride = n / length;
+        for (long int start = 0; start < n; start += length) {
+            for (long int j = 0; j < previous; j++) {
+                double complex *x = &work[start + j];
+                double complex a[5];
+                a[0] = x[0];
+                for (int q = 1; q < r; q++)
+                    a[q] = x[q * previous] * fft->twiddles[j * q * stride];
+                if (r == 2) {
+                    x[0] = a[0] + a[1];
+                    x[previous] = a[0] - a[1];
+                } else if (r == 4) {
+                    double complex t0 = a[0] + a[2], t1 = a[0] - a[2];
+                    double complex t2 = a[1] + a[3], t3 = -I * (a[1] - a[3]);
+                    x[0] = t0 + t2;
+                    x[previous] = t1 + t3;
+                    x[2 * previous] = t0 - t2;
+                    x[3 * previous] = t1 - t3;
+                } else {
+                    // DFT direta de tamanho 3 ou 5: w_r^(qk) = twiddles[qk n / r]
+                    long int root = n / r;
+                    for (int k = 0; k < r; k++) {
+                        double complex sum = a[0];
+                        for (int q = 1; q < r; q++)
+                            sum += a[q] * fft->twiddles[(q * k % r) * root];
+                        x[k * previous] = sum;
+                    }
+                }
+            }
+        }
+        previous = length;
+    }
+    memcpy(data, work, sizeof(double complex) * n);
+}
+
+
+static void dct_engine_destroy(dct_engine_t *engine) {
+    fft_destroy(&engine->fft);
+    free(engine->chirp);
+    free(engine->filter);
+    free(engine->rotation);
+    free(engine->scale);
+}
+
+
+static int dct_engine_create(dct_engine_t *engine, long int N) {
+    memset(engine, 0, sizeof(dct_engine_t));
+    engine->N = N;
+    int factors[FFT_MAX_FACTORS];
+    engine->bluestein = fft_factor(N, factors) < 0;
+    engine->rotation = (double complex*)malloc(sizeof(double complex) * N);
+    engine->scale = (double*)malloc(sizeof(double) * N);
+    if (engine->rotation == NULL || engine->scale == NULL)
+        return -1;
+    for (long int k = 0; k < N; k++) {
+        engine->rotation[k] = cexp(-PI * I * k / (2.0 * N));
+        engine->scale[k] = (k == 0) ? sqrt(1.0 / N) : sqrt(2.0 / N);
+    }
+
+    if (!engine->bluestein)
+        return fft_create(&engine->fft, N);
+
+    // Bluestein: X[k] = chirp[k] * sum_j (x[j] chirp[j]) conj(chirp[k - j]),
+    // uma convolução feita com FFTs de tamanho M. j² é reduzido mod 2N
+    // em inteiros, para o ângulo não crescer com j. M potência de 2 é no
+    // máximo 4N; um M 2-3-5 menor quase não muda o tempo.
+    long int M = 1;
+    while (M < 2 * N - 1)
+        M *= 2;
+    if (fft_create(&engine->fft, M) != 0)
+        return -1;
+    engine->chirp = (double complex*)malloc(sizeof(double complex) * N);
+    engine->filter = (double complex*)calloc(M, sizeof(double complex));
+    double complex *work = (double complex*)malloc(sizeof(double complex) * M);
+    if (engine->chirp == NULL || engine->filter == NULL || work == NULL) {
+        free(work);
+        return -1;
+    }
+    for (long int j = 0; j < N; j++)
+        engine->chirp[j] = cexp(-PI * I * (double)(j * j % (2 * N)) / N);
+    engine->filter[0] = conj(engine->chirp[0]);
+    for (long int j = 1; j < N; j++)
+        engine->filter[j] = engine->filter[M - j] = conj(engine->chirp[j]);
+    fft_execute(&engine->fft, engine->filter, work);
+    free(work);
+    return 0;
+}
+
+
+static int dct_scratch_create(dct_scratch_t *scratch, const dct_engine_t *engine) {
+    scratch->v = (double complex*)malloc(sizeof(double complex) * engine->N);
+    scratch->work = (double complex*)malloc(sizeof(double complex) * engine->fft.n);
+    scratch->fft_work = (double complex*)malloc(sizeof(double complex) * engine->fft.n);
+    return (scratch->v == NULL || scratch->work == NULL || scratch->fft_work == NULL) ? -1 : 0;
+}
+
+
+static void dct_scratch_destroy(dct_scratch_t *scratch) {
+    free(scratch->v);
+    free(scratch->work);
+    free(scratch->fft_work);
+}
+
+
+// FFT direta de tamanho N de v, no lugar
+static void engine_fft(const dct_engine_t *engine, const dct_scratch_t *scratch, double complex *v) {
+    long int N = engine->N;
+    if (!engine->bluestein) {
+        fft_execute(&engine->fft, v, scratch->fft_work);
+        return;
+    }
+    double complex *work = scratch->work;
+    long int M = engine->fft.n;
+    for (long int j = 0; j < N; j++)
+        work[j] = v[j] * engine->chirp[j];
+    for (long int j = N; j < M; j++)
+        work[j] = 0;
+    fft_execute(&engine->fft, work, scratch->fft_work);
+    // Convolução: produto no domínio da frequência e FFT inversa
+    for (long int j = 0; j < M; j++)
+        work[j] = conj(work[j] * engine->filter[j]);
+    fft_execute(&engine->fft, work, scratch->fft_work);
+    for (long int k = 0; k < N; k++)
+        v[k] = engine->chirp[k] * conj(work[k]) / M;
+}
+
+
+// DCT-II ortonormal
+static void engine_forward(const dct_engine_t *engine, const dct_scratch_t *scratch,
+                           const double *input, double *output) {
+    long int N = engine->N;
+    double complex *v = scratch->v;
+    // Pares em ordem, ímpares de trás para frente
+    for (long int n = 0; 2 * n < N; n++)
+        v[n] = input[2 * n];
+    for (long int n = 0; 2 * n + 1 < N; n++)
+        v[N - 1 - n] = input[2 * n + 1];
+    engine_fft(engine, scratch, v);
+    for (long int k = 0; k < N; k++)
+        output[k] = engine->scale[k] * creal(engine->rotation[k] * v[k]);
+}
+
+
+// DCT-III ortonormal (inversa da DCT-II): V[k] = conj(rotation[k]) (Y[k] - i Y[N - k])
+// e a entrada reordenada é a FFT inversa de V
+static void engine_inverse(const dct_engine_t *engine, const dct_scratch_t *scratch,
+                           const double *input, double *output) {
+    long int N = engine->N;
+    double complex *v = scratch->v;
+    for (long int k = 0; k < N; k++) {
+        double y = input[k] / engine->scale[k];
+        double y_mirror = (k > 0) ? input[N - k] / engine->scale[N - k] : 0.0;
+        v[k] = conj(conj(engine->rotation[k]) * (y - I * y_mirror));
+    }
+    engine_fft(engine, scratch, v);
+    for (long int n = 0; 2 * n < N; n++)
+        output[2 * n] = creal(v[n]) / N;
+    for (long int n = 0; 2 * n + 1 < N; n++)
+        output[2 * n + 1] = creal(v[N - 1 - n]) / N;
+}
+
+
+struct dct_plan {
+    long int N;
+    int type;
+    int threads;
+    int algorithm;
+    dct_engine_t engine;       // DCT_ALGORITHM_FAST
+    dct_scratch_t *scratch;    // uma por thread, DCT_ALGORITHM_FAST
+    double *table;             // N x N, DCT_ALGORITHM_TABLE
+};
+
+
+// Uma transformada com a memória de trabalho da thread t
+static void plan_execute_one(const dct_plan_t *plan, int t, const double *input, double *output) {
+    long int N = plan->N;
+    if (plan->algorithm == DCT_ALGORITHM_FAST) {
+        if (plan->type == DCT_TYPE_III)
+            engine_inverse(&plan->engine, &plan->scratch[t], input, output);
+        else
+            engine_forward(&plan->engine, &plan->scratch[t], input, output);
+        return;
+    }
+    // Linha k da tabela = c_k cos(π (2n + 1) k / 2N); a DCT-III usa a
+    // transposta, somando uma linha inteira por entrada
+    if (plan->type == DCT_TYPE_III) {
+        for (long int n = 0; n < N; n++)
+            output[n] = 0.0;
+        for (long int k = 0; k < N; k++) {
+            const double *row = &plan->table[k * N];
+            for (long int n = 0; n < N; n++)
+                output[n] += row[n] * input[k];
+        }
+    } else {
+        for (long int k = 0; k < N; k++) {
+            const double *row = &plan->table[k * N];
+            double sum = 0.0;
+            for (long int n = 0; n < N; n++)
+                sum += row[n] * input[n];
+            output[k] = sum;
+        }
+    }
+}
+
+
+static int plan_prepare(dct_plan_t *plan, int algorithm) {
+    long int N = plan->N;
+    plan->algorithm = algorithm;
+    if (algorithm == DCT_ALGORITHM_TABLE) {
+        plan->table = (double*)allocate_aligned_memory(sizeof(double) * N * N);
+        if (plan->table == NULL)
+            return -1;
+        for (long int k = 0; k < N; k++) {
+            double ck = (k == 0) ? sqrt(1.0 / N) : sqrt(2.0 / N);
+            for (long int n = 0; n < N; n++)
+                plan->table[k * N + n] = ck * cos(PI * (double)((2 * n + 1) * k % (4 * N)) / (2.0 * N));
+        }
+        return 0;
+    }
+    if (dct_engine_create(&plan->engine, N) != 0)
+        return -1;
+    plan->scratch = (dct_scratch_t*)calloc(plan->threads, sizeof(dct_scratch_t));
+    if (plan->scratch == NULL)
+        return -1;
+    for (int t = 0; t < plan->threads; t++) {
+        if (dct_scratch_create(&plan->scratch[t], &plan->engine) != 0)
+            return -1;
+    }
+    return 0;
+}
+
+
+static void plan_release(dct_plan_t *plan) {
+    if (plan->table != NULL)
+        free_aligned_memory(plan->table);
+    plan->table = NULL;
+    if (plan->scratch != NULL) {
+        for (int t = 0; t < plan->threads; t++)
+            dct_scratch_destroy(&plan->scratch[t]);
+        free(plan->scratch);
+        plan->scratch = NULL;
+    }
+    dct_engine_destroy(&plan->engine);
+    memset(&plan->engine, 0, sizeof(dct_engine_t));
+}
+
+
+// Menor tempo de uma transformada em DCT_PLAN_MEASUREMENTS execuções
+static double plan_measure(const dct_plan_t *plan, const double *input, double *output) {
+    double best = 0.0;
+    for (int m = 0; m < DCT_PLAN_MEASUREMENTS; m++) {
+        double start = omp_get_wtime();
+        plan_execute_one(plan, 0, input, output);
+        double elapsed = omp_get_wtime() - start;
+        if (m == 0 || elapsed < best)
+            best = elapsed;
+    }
+    return best;
+}
+
+
+dct_plan_t *dct_plan_create(long int N, int type, int threads, int algorithm) {
+    if (N < 1 || (type != DCT_TYPE_II && type != DCT_TYPE_III) || threads < 1)
+        return NULL;
+    if (algorithm == DCT_ALGORITHM_TABLE && N > DCT_PLAN_TABLE_LIMIT)
+        return NULL;
+    dct_plan_t *plan = (dct_plan_t*)calloc(1, sizeof(dct_plan_t));
+    if (plan == NULL)
+        return NULL;
+    plan->N = N;
+    plan->type = type;
+    plan->threads = threads;
+
+    if (algorithm == DCT_ALGORITHM_AUTO && N > DCT_PLAN_TABLE_LIMIT)
+        algorithm = DCT_ALGORITHM_FAST;
+    if (algorithm != DCT_ALGORITHM_AUTO) {
+        if (plan_prepare(plan, algorithm) != 0) {
+            dct_plan_destroy(plan);
+            return NULL;
+        }
+        return plan;
+    }
+
+    // Escolha medida: as duas versões são montadas e executadas sobre o
+    // mesmo vetor, e fica a mais rápida
+    double *input = (double*)malloc(sizeof(double) * N);
+    double *output = (double*)malloc(sizeof(double) * N);
+    for (long int n = 0; n < N; n++)
+        input[n] = (double)rand() / RAND_MAX;
+    double time_table = -1.0;
+    if (plan_prepare(plan, DCT_ALGORITHM_TABLE) == 0)
+        time_table = plan_measure(plan, input, output);
+    plan_release(plan);
+    if (plan_prepare(plan, DCT_ALGORITHM_FAST) != 0) {
+        free(input);
+        free(output);
+        dct_plan_destroy(plan);
+        return NULL;
+    }
+    double time_fast = plan_measure(plan, input, output);
+    free(input);
+    free(output);
+    if (time_table >= 0 && time_table < time_fast) {
+        plan_release(plan);
+        // Se a tabela não puder ser montada de novo, fica a versão rápida
+        if (plan_prepare(plan, DCT_ALGORITHM_TABLE) != 0) {
+            plan_release(plan);
+            if (plan_prepare(plan, DCT_ALGORITHM_FAST) != 0) {
+                dct_plan_destroy(plan);
+                return NULL;
+            }
+        }
+    }
+    return plan;
+}
+
+
+int dct_plan_algorithm(const dct_plan_t *plan) {
+    return plan->algorithm;
+}
+
+
+void dct_plan_execute(const dct_plan_t *plan, const double *input, double *output) {
+    plan_execute_one(plan, 0, input, output);
+}
+
+
+void dct_plan_execute_many(const dct_plan_t *plan, const double *input, double *output, long int count) {
+    long int N = plan->N;
+    #pragma omp parallel num_threads(plan->threads)
+    {
+        int t = omp_get_thread_num();
+        #pragma omp for schedule(static)
+        for (long int v = 0; v < count; v++)
+            plan_execute_one(plan, t, &input[v * N], &output[v * N]);
+    }
+}
+
+
+void dct_plan_destroy(dct_plan_t *plan) {
+    if (plan == NULL)
+        return;
+    plan_release(plan);
+    free(plan);
+}
+
+
+static int transform_1d(const double *input, double *output, long int N, int type) {
+    if (N < 1)
+        return 0;
+    dct_plan_t *plan = dct_plan_create(N, type, 1, DCT_ALGORITHM_FAST);
+    if (plan == NULL) {
+        fprintf(stderr, "\nError: could not allocate the DCT tables for N = %ld", N);
+        return -1;
+    }
+    dct_plan_execute(plan, input, output);
+    dct_plan_destroy(plan);
+    return 0;
+}
+
+
+int DCT1D_fast(const double *input, double *output, long int N) {
+    return transform_1d(input, output, N, DCT_TYPE_II);
+}
+
+
+int IDCT1D_fast(const double *input, double *output, long int N) {
+    return transform_1d(input, output, N, DCT_TYPE_III);
+}
+
+
+// destination (columns x lines) = transposta de source (lines x columns),
+// em blocos TRANSPOSE_TILE x TRANSPOSE_TILE divididos entre as threads
+static void transpose(const double *source, double *destination, long int lines, long int columns) {
+    long int tile_lines = (lines + TRANSPOSE_TILE - 1) / TRANSPOSE_TILE;
+    long int tile_columns = (columns + TRANSPOSE_TILE - 1) / TRANSPOSE_TILE;
+    #pragma omp for schedule(static) collapse(2)
+    for (long int ti = 0; ti < tile_lines; ti++) {
+        for (long int tj = 0; tj < tile_columns; tj++) {
+            long int i_end = (ti + 1) * TRANSPOSE_TILE < lines ? (ti + 1) * TRANSPOSE_TILE : lines;
+            long int j_end = (tj + 1) * TRANSPOSE_TILE < columns ? (tj + 1) * TRANSPOSE_TILE : columns;
+            for (long int i = ti * TRANSPOSE_TILE; i < i_end; i++)
+                for (long int j = tj * TRANSPOSE_TILE; j < j_end; j++)
+                    M(j, i, lines, destination) = M(i, j, columns, source);
+        }
+    }
+}
+
+
+// Linhas em paralelo, transposição em blocos, colunas (agora linhas da
+// transposta) em paralelo e transposição de volta, tudo numa região
+// paralela; um plano por dimensão, com a memória de trabalho de cada thread
+static int transform_2d(const double *input, double *output, long int lines, long int columns, int type) {
+    if (lines < 1 || columns < 1)
+        return 0;
+    int threads = omp_get_max_threads();
+    dct_plan_t *row_plan = dct_plan_create(columns, type, threads, DCT_ALGORITHM_FAST);
+    dct_plan_t *column_plan = dct_plan_create(lines, type, threads, DCT_ALGORITHM_FAST);
+    if (row_plan == NULL || column_plan == NULL) {
+        fprintf(stderr, "\nError: could not allocate the DCT tables for %ld x %ld", lines, columns);
+        dct_plan_destroy(row_plan);
+        dct_plan_destroy(column_plan);
+        return -1;
+    }
+    double *buffer = (double*)allocate_aligned_memory(sizeof(double) * lines * columns);
+    double *transposed = (double*)allocate_aligned_memory(sizeof(double) * lines * columns);
+    if (buffer == NULL || transposed == NULL) {
+        fprintf(stderr, "\nError: could not allocate the 2D buffers for %ld x %ld", lines, columns);
+        free_aligned_memory(buffer);
+        free_aligned_memory(transposed);
+        dct_plan_destroy(row_plan);
+        dct_plan_destroy(column_plan);
+        return -1;
+    }
+
+    #pragma omp parallel num_threads(threads)
+    {
+        int t = omp_get_thread_num();
+
+        #pragma omp for schedule(static)
+        for (long int i = 0; i < lines; i++)
+            plan_execute_one(row_plan, t, &M(i, 0, columns, input), &M(i, 0, columns, buffer));
+
+        transpose(buffer, transposed, lines, columns);
+
+        #pragma omp for schedule(static)
+        for (long int j = 0; j < columns; j++)
+            plan_execute_one(column_plan, t, &M(j, 0, lines, transposed), &M(j, 0, lines, buffer));
+
+        transpose(buffer, output, columns, lines);
+    }
+
+    free_aligned_memory(buffer);
+    free_aligned_memory(transposed);
+    dct_plan_destroy(row_plan);
+    dct_plan_destroy(column_plan);
+    return 0;
+}
+
+
+int DCT2D_parallel(const double *input, double *output, long int lines, long int columns) {
+    return transform_2d(input, output, lines, columns, DCT_TYPE_II);
+}
+
+
+int IDCT2D_parallel(const double *input, double *output, long int lines, long int columns) {
+    return transform_2d(input, output, lines, columns, DCT_TYPE_III);
+}
@@ -0,0 +1,148 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <immintrin.h>
+#include <libppc.h>
+#include <omp.h>
+
+#include "transformadadiscretadecossenos.h"
+
+// As funções SIMD são compiladas para o seu conjunto de instruções com o
+// atributo target e escolhidas em tempo de execução; o optimize("O2") evita
+// que, no build -O0, cada intrínseca passe pela pilha.
+#define AVX2 __attribute__((target("avx2,fma"), optimize("O2")))
+#define AVX512 __attribute__((target("avx512f"), optimize("O2")))
+
+// Termos gerados pela recorrência entre duas chamadas à libm
+#define DCT_RECURRENCE_RESEED 128
+
+// Calcula as somas de width saídas vizinhas, a partir de output[k0]
+typedef void (*recurrence_kernel_t)(const double *input, double *sums, long int N, long int k0);
+
+
+int best_simd_isa(void) {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+        return SIMD_AVX512;
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        return SIMD_AVX2;
+    return SIMD_SCALAR;
+}
+
+
+// cos e sin de π (2n + 1) k / 2N, com o ângulo reduzido em inteiros:
+// (2n + 1) k mod 4N é exato, então a libm sempre recebe um ângulo em
+// [0, 2π), por maior que seja n k
+static inline void seed(long int n, long int k, long int N, double *c, double *s) {
+    long int m = (2 * n + 1) * k % (4 * N);
+    double angle = PI * m / (2.0 * N);
+    *c = cos(angle);
+    *s = sin(angle);
+}
+
+
+// Rotação de θ = π k / N na forma estabilizada: α = 2 sin²(θ/2) e β = sin θ
+// são pequenos quando θ é pequeno, e c - (α c + β s) não perde os dígitos
+// que 2 cos θ c_n - c_{n-1} perderia
+static inline void rotation(long int k, long int N, double *alpha, double *beta) {
+    double half = sin(PI * k / (2.0 * N));
+    *alpha = 2.0 * half * half;
+    *beta = sin(PI * k / N);
+}
+
+
+static void sums_scalar(const double *input, double *sums, long int N, long int k0) {
+    double alpha, beta, c, s, sum = 0.0;
+    rotation(k0, N, &alpha, &beta);
+    for (long int first = 0; first < N; first += DCT_RECURRENCE_RESEED) {
+        long int last = (first + DCT_RECURRENCE_RESEED < N) ? first + DCT_RECURRENCE_RESEED : N;
+        seed(first, k0, N, &c, &s);
+        for (long int n = first; n < last; n++) {
+            sum += input[n] * c;
+            double next = c - (alpha * c + beta * s);
+            s = s - (alpha * s - beta * c);
+            c = next;
+        }
+    }
+    sums[0] = sum;
+}
+
+
+// 4 saídas por passada: cada lane é uma recorrência de um k diferente e
+// input[n] é o mesmo para todas
+static AVX2 void sums_avx2(const double *input, double *sums, long int N, long int k0) {
+    double alpha[4], beta[4], c[4], s[4];
+    for (int lane = 0; lane < 4; lane++)
+        rotation(k0 + lane, N, &alpha[lane], &beta[lane]);
+    __m256d va = _mm256_loadu_pd(alpha), vb = _mm256_loadu_pd(beta);
+    __m256d sum = _mm256_setzero_pd();
+
+    for (long int first = 0; first < N; first += DCT_RECURRENCE_RESEED) {
+        long int last = (first + DCT_RECURRENCE_RESEED < N) ? first + DCT_RECURRENCE_RESEED : N;
+        for (int lane = 0; lane < 4; lane++)
+            seed(first, k0 + lane, N, &c[lane], &s[lane]);
+        __m256d vc = _mm256_loadu_pd(c), vs = _mm256_loadu_pd(s);
+        for (long int n = first; n < last; n++) {
+            sum = _mm256_fmadd_pd(_mm256_broadcast_sd(&input[n]), vc, sum);
+            __m256d next = _mm256_sub_pd(vc, _mm256_fmadd_pd(va, vc, _mm256_mul_pd(vb, vs)));
+            vs = _mm256_sub_pd(vs, _mm256_fmsub_pd(va, vs, _mm256_mul_pd(vb, vc)));
+            vc = next;
+        }
+    }
+    _mm256_storeu_pd(sums, sum);
+}
+
+
+// 8 saídas por passada
+static AVX512 void sums_avx512(const double *input, double *sums, long int N, long int k0) {
+    double alpha[8], beta[8], c[8], s[8];
+    for (int lane = 0; lane < 8; lane++)
+        rotation(k0 + lane, N, &alpha[lane], &beta[lane]);
+    __m512d va = _mm512_loadu_pd(alpha), vb = _mm512_loadu_pd(beta);
+    __m512d sum = _mm512_setzero_pd();
+
+    for (long int first = 0; first < N; first += DCT_RECURRENCE_RESEED) {
+        long int last = (first + DCT_RECURRENCE_RESEED < N) ? first + DCT_RECURRENCE_RESEED : N;
+        for (int lane = 0; lane < 8; lane++)
+            seed(first, k0 + lane, N, &c[lane], &s[lane]);
+        __m512d vc = _mm512_loadu_pd(c), vs = _mm512_loadu_pd(s);
+        for (long int n = first; n < last; n++) {
+            sum = _mm512_fmadd_pd(_mm512_set1_pd(input[n]), vc, sum);
+            __m512d next = _mm512_sub_pd(vc, _mm512_fmadd_pd(va, vc, _mm512_mul_pd(vb, vs)));
+            vs = _mm512_sub_pd(vs, _mm512_fmsub_pd(va, vs, _mm512_mul_pd(vb, vc)));
+            vc = next;
+        }
+    }
+    _mm512_storeu_pd(sums, sum);
+}
+
+
+int DCT1D_recurrence(const double *input, double *output, long int N, int isa) {
+    if (isa == SIMD_AUTO)
+        isa = best_simd_isa();
+    recurrence_kernel_t kernel = sums_scalar;
+    long int width = 1;
+    if (isa == SIMD_AVX512) {
+        kernel = sums_avx512;
+        width = 8;
+    } else if (isa == SIMD_AVX2) {
+        kernel = sums_avx2;
+        width = 4;
+    }
+
+    // Grupos de width saídas; as últimas N % width usam o kernel escalar
+    long int groups = N / width;
+    #pragma omp parallel for schedule(static)
+    for (long int g = 0; g <= groups; g++) {
+        long int k0 = g * width;
+        if (g < groups)
+            kernel(input, &output[k0], N, k0);
+        else
+            for (long int k = k0; k < N; k++)
+                sums_scalar(input, &output[k], N, k);
+    }
+
+    for (long int k = 0; k < N; k++)
+        output[k] *= (k == 0) ? sqrt(1.0 / N) : sqrt(2.0 / N);
+    return isa;
+}
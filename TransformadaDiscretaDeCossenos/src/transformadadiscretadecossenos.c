@@ -7,14 +7,64 @@
 #include <math.h>
 #include <string.h>
 
+#include "transformadadiscretadecossenos.h"
+
 #define SIZE 200000
-#define PI 3.14159265358979323846
+
+// Quadro 4K (3840 x 2160), o padrão das opções -m 2d e -m 8x8
+#define FRAME_LINES 2160
+#define FRAME_COLUMNS 3840
+
+// Elementos de um lote da opção -m plan: o lote tem (1 << 20) / N vetores
+#define PLAN_BATCH_ELEMENTS (1L << 20)
+
+// Acima de tantos elementos a referência direta da DCT 2D (O(L C (L + C)))
+// demora demais e só a volta pela inversa é conferida
+#define DCT2D_REFERENCE_LIMIT (512 * 512)
+
+// Erro máximo aceito, relativo ao maior |output_serial[k]|, para as
+// variantes que não fazem as mesmas contas que DCT1D_serial
+#define DCT_TOLERANCE 1e-9
 
 enum implementations_enum {
     TYPE_SERIAL = 1,
-    TYPE_PARALLEL
+    TYPE_PARALLEL,
+    TYPE_RECURRENCE,
+    TYPE_BLOCKED,
+    TYPE_FAST,
+    TYPE_2D,
+    TYPE_8X8,
+    TYPE_PLAN
 };
 
+// Nomes aceitos pela opção -m, indexados por implementations_enum
+static const char *implementation_names[] = {
+    [TYPE_PARALLEL] = "parallel",
+    [TYPE_RECURRENCE] = "recurrence",
+    [TYPE_BLOCKED] = "blocked",
+    [TYPE_FAST] = "fast",
+    [TYPE_2D] = "2d",
+    [TYPE_8X8] = "8x8",
+    [TYPE_PLAN] = "plan"
+};
+
+// Nomes aceitos pela opção -a, indexados por dct_algorithm_enum
+static const char *algorithm_names[] = {
+    [DCT_ALGORITHM_TABLE] = "table",
+    [DCT_ALGORITHM_FAST] = "fast"
+};
+
+// Nomes aceitos pela opção -i, indexados por simd_isa_enum
+static const char *isa_names[] = {
+    [SIMD_SCALAR] = "scalar",
+    [SIMD_AVX2] = "avx2",
+    [SIMD_AVX512] = "avx512"
+};
+
+static int simd_isa = SIMD_AUTO;
+
+typedef void (*dct_function_t)(const double *input, double *output, long int N);
+
 void DCT1D_serial(const double *input, double *output, long int N) {
     double ck = 1.0;
 
@@ -41,7 +91,8 @@ void DCT1D_serial(const double *input, double *output, long int N) {
 
 void DCT1D_parallel(const double *input, double *output, long int N) {
     // Cada iteração calcula um valor exclusivo de output[k].
-    #pragma omp parallel for
+    // schedule(static) é o mesmo usado na alocação first-touch de output.
+    #pragma omp parallel for schedule(static)
     for (long int k = 0; k < N; k++) {
         double ck = (k == 0) ? sqrt(1.0/N) : sqrt(2.0/N);
 
@@ -57,40 +108,593 @@ void DCT1D_parallel(const double *input, double *output, long int N) {
 }
 
 
-int main(int argc, char **argv) {
-    srand(time(NULL));
-    double *vector, *output_serial, *output_2, *output_4;
-    if (access("vector.dat", F_OK) != 0) {
+// Define o número de threads e aplica a política de afinidade escolhida
+void set_threads(int number_of_threads, int bind_policy) {
+    omp_set_num_threads(number_of_threads);
+    if (bind_policy != BIND_NONE && bind_omp_threads(bind_policy) != 0) {
+        printf("\nWarning: could not bind all threads");
+    }
+}
+
+
+int parse_implementation(const char *name) {
+    int count = sizeof(implementation_names) / sizeof(implementation_names[0]);
+    for (int i = 0; i < count; i++) {
+        if (implementation_names[i] != NULL && strcmp(implementation_names[i], name) == 0)
+            return i;
+    }
+    return -1;
+}
+
+
+// Carrega vector.dat ou gera um novo se o arquivo não existe ou tem menos
+// que size elementos
+double *load_or_generate_vector(long int size) {
+    double *vector = NULL;
+    if (access("vector.dat", F_OK) == 0) {
+        printf("\nLoading vector from file...");
+        vector = load_double_vector("vector.dat", size);
+    }
+    if (vector == NULL) {
         printf("\nGenerating new vector...");
-        vector = generate_random_double_vector(SIZE, 0.0, 1000.0);
-        save_double_vector(vector, SIZE, "vector.dat");
+        vector = generate_random_double_vector(size, 0.0, 1000.0);
+        save_double_vector(vector, size, "vector.dat");
+    }
+    return vector;
+}
+
+
+// Maior diferença absoluta entre as saídas e o erro RMS, ambos relativos
+// ao maior |reference[k]|
+void compare_outputs(const double *reference, const double *output, long int size,
+                     double *max_error, double *rms_error) {
+    double largest = 0, worst = 0, squares = 0;
+    for (long int k = 0; k < size; k++) {
+        double error = fabs(output[k] - reference[k]);
+        if (fabs(reference[k]) > largest) largest = fabs(reference[k]);
+        if (error > worst) worst = error;
+        squares += error * error;
+    }
+    *max_error = (largest > 0) ? worst / largest : worst;
+    *rms_error = (size > 0 && largest > 0) ? sqrt(squares / size) / largest : 0;
+}
+
+
+// Imprime o modo de páginas grandes escolhido em -p
+void print_huge_page_mode(void) {
+    int mode = get_huge_page_mode();
+    printf("\nHuge page mode: %s", mode == HUGE_PAGES_EXPLICIT ? "explicit" :
+        (mode == HUGE_PAGES_TRANSPARENT ? "thp" : "none"));
+}
+
+
+// Imprime as falhas de dTLB medidas durante a transformada
+void print_dtlb_misses(long long misses) {
+    if (misses < 0) {
+        printf("\ndTLB misses: not available");
     } else {
-        printf("\nLoading vector from file...");
-        vector = load_double_vector("vector.dat", SIZE);
+        printf("\ndTLB misses: %lld", misses);
+    }
+}
+
+
+// Roda uma variante com 1, 2 e 4 threads e compara cada saída com a de
+// DCT1D_serial (libm), com tolerância DCT_TOLERANCE
+int run_variant(const char *name, dct_function_t dct, long int size, int bind_policy) {
+    double *vector = load_or_generate_vector(size);
+    double *output_serial = (double*)malloc(sizeof(double) * size);
+
+    print_huge_page_mode();
+    printf("\nRunning serial DCT 1D...");
+    double start = omp_get_wtime();
+    DCT1D_serial(vector, output_serial, size);
+    double time_serial = omp_get_wtime() - start;
+    printf("\nSerial time: %.6f seconds\n", time_serial);
+    save_double_vector(output_serial, size, "dct_serial.dat");
+
+    int errors = 0;
+    for (int threads = 1; threads <= 4; threads *= 2) {
+        printf("\n----------------------------------------------\n");
+        set_threads(threads, bind_policy);
+        double *output = allocate_double_vector_first_touch(size);
+        printf("\nRunning %s DCT 1D (%d threads)...", name, threads);
+        start_dtlb_miss_counters();
+        start = omp_get_wtime();
+        dct(vector, output, size);
+        double time_parallel = omp_get_wtime() - start;
+        long long tlb_misses = stop_dtlb_miss_counters();
+        printf("\nParallel time (%d threads): %.6f seconds", threads, time_parallel);
+        print_dtlb_misses(tlb_misses);
+        printf("\n");
+
+        char filename[64];
+        snprintf(filename, sizeof(filename), "dct_%s_%d.dat", name, threads);
+        save_double_vector(output, size, filename);
+        double speedup = time_serial / time_parallel;
+        printf("\nSpeedup (%d threads): %.3f", threads, speedup);
+        printf("\nEficiência (%d threads): %.3f", threads, speedup / threads);
+
+        double max_error, rms_error;
+        compare_outputs(output_serial, output, size, &max_error, &rms_error);
+        printf("\nError versus libm (relative to max |X[k]|): max %.3e | RMS %.3e", max_error, rms_error);
+        if (max_error <= DCT_TOLERANCE) {
+            printf("\nOK! Serial and %s (%d threads) outputs match!", name, threads);
+        } else {
+            printf("\nERROR! Outputs do NOT match for %s with %d threads!", name, threads);
+            errors++;
+        }
+        free_aligned_memory(output);
+    }
+
+    free_aligned_memory(vector);
+    free(output_serial);
+    printf("\n");
+    return errors > 0;
+}
+
+
+void dct_recurrence(const double *input, double *output, long int N) {
+    int isa = DCT1D_recurrence(input, output, N, simd_isa);
+    printf("\nInstruction set: %s", isa_names[isa]);
+}
+
+
+void dct_blocked(const double *input, double *output, long int N) {
+    int isa = DCT1D_blocked(input, output, N, simd_isa);
+    printf("\nInstruction set: %s", isa_names[isa]);
+}
+
+
+void dct_fast(const double *input, double *output, long int N) {
+    DCT1D_fast(input, output, N);
+}
+
+
+// DCT 2D de referência: DCT1D_serial nas linhas e depois nas colunas
+void DCT2D_serial(const double *input, double *output, long int lines, long int columns) {
+    double *rows = (double*)malloc(sizeof(double) * lines * columns);
+    double *column = (double*)malloc(sizeof(double) * lines);
+    double *transformed = (double*)malloc(sizeof(double) * lines);
+    for (long int i = 0; i < lines; i++)
+        DCT1D_serial(&M(i, 0, columns, input), &M(i, 0, columns, rows), columns);
+    for (long int j = 0; j < columns; j++) {
+        for (long int i = 0; i < lines; i++)
+            column[i] = M(i, j, columns, rows);
+        DCT1D_serial(column, transformed, lines);
+        for (long int i = 0; i < lines; i++)
+            M(i, j, columns, output) = transformed[i];
+    }
+    free(rows);
+    free(column);
+    free(transformed);
+}
+
+
+// Carrega matrix_<L>x<C>.dat com load_double_matrix ou gera uma nova
+double *load_or_generate_matrix(long int lines, long int columns) {
+    char matrix_file[64];
+    snprintf(matrix_file, sizeof(matrix_file), "matrix_%ldx%ld.dat", lines, columns);
+    double *matrix = NULL;
+    if (access(matrix_file, F_OK) == 0) {
+        printf("\nLoading %ld x %ld matrix from file...", lines, columns);
+        matrix = load_double_matrix(matrix_file, lines, columns);
+    }
+    if (matrix == NULL) {
+        printf("\nGenerating new %ld x %ld matrix...", lines, columns);
+        matrix = generate_random_double_matrix(lines, columns);
+        save_double_matrix(matrix, lines, columns, matrix_file);
+    }
+    return matrix;
+}
+
+
+// DCT 2D de uma matriz lines x columns carregada por load_or_generate_matrix,
+// com 1, 2 e 4 threads. A saída é comparada com a referência direta (só
+// para matrizes pequenas) e a inversa precisa devolver a matriz original.
+// A vazão é em megapixels por segundo.
+int run_2d(long int lines, long int columns, int bind_policy) {
+    long int size = lines * columns;
+    double *matrix = load_or_generate_matrix(lines, columns);
+
+    double *reference = NULL;
+    if (size <= DCT2D_REFERENCE_LIMIT) {
+        reference = (double*)malloc(sizeof(double) * size);
+        printf("\nRunning serial DCT 2D...");
+        double start = omp_get_wtime();
+        DCT2D_serial(matrix, reference, lines, columns);
+        printf("\nSerial time: %.6f seconds\n", omp_get_wtime() - start);
+        save_double_matrix(reference, lines, columns, "dct2d_serial.dat");
+    }
+
+    int errors = 0;
+    for (int threads = 1; threads <= 4; threads *= 2) {
+        printf("\n----------------------------------------------\n");
+        set_threads(threads, bind_policy);
+        double *output = (double*)allocate_aligned_memory(sizeof(double) * size);
+        double *restored = (double*)allocate_aligned_memory(sizeof(double) * size);
+
+        printf("\nRunning DCT 2D (%d threads)...", threads);
+        double start = omp_get_wtime();
+        int status = DCT2D_parallel(matrix, output, lines, columns);
+        double time_forward = omp_get_wtime() - start;
+        start = omp_get_wtime();
+        if (status == 0)
+            status = IDCT2D_parallel(output, restored, lines, columns);
+        double time_inverse = omp_get_wtime() - start;
+        if (status != 0) {
+            free_aligned_memory(output);
+            free_aligned_memory(restored);
+            free_aligned_memory(matrix);
+            free(reference);
+            return 1;
+        }
+        printf("\nForward time (%d threads): %.6f seconds | %.2f MP/s", threads,
+               time_forward, size / time_forward / 1e6);
+        printf("\nInverse time (%d threads): %.6f seconds | %.2f MP/s\n", threads,
+               time_inverse, size / time_inverse / 1e6);
+
+        char filename[64];
+        snprintf(filename, sizeof(filename), "dct2d_%d.dat", threads);
+        save_double_matrix(output, lines, columns, filename);
+
+        double max_error, rms_error;
+        if (reference != NULL) {
+            compare_outputs(reference, output, size, &max_error, &rms_error);
+            printf("\nError versus direct DCT 2D: max %.3e | RMS %.3e", max_error, rms_error);
+            if (max_error > DCT_TOLERANCE) {
+                printf("\nERROR! DCT 2D does NOT match the direct DCT with %d threads!", threads);
+                errors++;
+            }
+        }
+        compare_outputs(matrix, restored, size, &max_error, &rms_error);
+        printf("\nRound trip error (DCT-III of DCT-II): max %.3e | RMS %.3e", max_error, rms_error);
+        if (max_error <= DCT_TOLERANCE) {
+            printf("\nOK! Inverse DCT 2D (%d threads) restores the matrix!", threads);
+        } else {
+            printf("\nERROR! Inverse DCT 2D does NOT restore the matrix with %d threads!", threads);
+            errors++;
+        }
+        free_aligned_memory(output);
+        free_aligned_memory(restored);
     }
-    output_serial = (double*)malloc(sizeof(double) * SIZE);
-    output_2 = (double*)malloc(sizeof(double) * SIZE);
-    output_4 = (double*)malloc(sizeof(double) * SIZE);
+
+    free_aligned_memory(matrix);
+    free(reference);
+    printf("\n");
+    return errors > 0;
+}
+
+
+// DCT de cada bloco 8 x 8 com DCT1D_serial nas linhas e colunas do bloco
+void DCT8x8_serial(const double *input, double *output, long int lines, long int columns) {
+    double block[64], transformed[64];
+    for (long int i = 0; i < lines; i += 8) {
+        for (long int j = 0; j < columns; j += 8) {
+            for (int u = 0; u < 8; u++)
+                for (int v = 0; v < 8; v++)
+                    block[v * 8 + u] = M((i + u), (j + v), columns, input);
+            for (int v = 0; v < 8; v++)
+                DCT1D_serial(&block[v * 8], &transformed[v * 8], 8);
+            for (int u = 0; u < 8; u++)
+                for (int v = 0; v < 8; v++)
+                    block[u * 8 + v] = transformed[v * 8 + u];
+            for (int u = 0; u < 8; u++)
+                DCT1D_serial(&block[u * 8], &M((i + u), j, columns, output), 8);
+        }
+    }
+}
+
+
+// Blocos 8 x 8 de uma matriz lines x columns com 1, 2 e 4 threads, contra
+// DCT8x8_serial (DCT1D_serial de N = 8 em cada linha e coluna); a inversa
+// precisa devolver a matriz original
+int run_8x8(long int lines, long int columns, int bind_policy) {
+    long int size = lines * columns;
+    double *matrix = load_or_generate_matrix(lines, columns);
+    double *reference = (double*)allocate_aligned_memory(sizeof(double) * size);
+
+    printf("\nRunning serial 8x8 block DCT...");
+    double start = omp_get_wtime();
+    DCT8x8_serial(matrix, reference, lines, columns);
+    double time_serial = omp_get_wtime() - start;
+    printf("\nSerial time: %.6f seconds | %.2f MP/s\n", time_serial, size / time_serial / 1e6);
+    save_double_matrix(reference, lines, columns, "dct8x8_serial.dat");
+
+    int errors = 0;
+    for (int threads = 1; threads <= 4; threads *= 2) {
+        printf("\n----------------------------------------------\n");
+        set_threads(threads, bind_policy);
+        double *output = (double*)allocate_aligned_memory(sizeof(double) * size);
+        double *restored = (double*)allocate_aligned_memory(sizeof(double) * size);
+
+        printf("\nRunning AAN 8x8 block DCT (%d threads)...", threads);
+        start = omp_get_wtime();
+        int isa = DCT8x8_forward(matrix, output, lines, columns, simd_isa);
+        double time_forward = omp_get_wtime() - start;
+        start = omp_get_wtime();
+        DCT8x8_inverse(output, restored, lines, columns, simd_isa);
+        double time_inverse = omp_get_wtime() - start;
+        printf("\nInstruction set: %s", isa_names[isa]);
+        printf("\nForward time (%d threads): %.6f seconds | %.2f MP/s", threads,
+               time_forward, size / time_forward / 1e6);
+        printf("\nInverse time (%d threads): %.6f seconds | %.2f MP/s\n", threads,
+               time_inverse, size / time_inverse / 1e6);
+        printf("\nSpeedup (%d threads): %.3f", threads, time_serial / time_forward);
+
+        char filename[64];
+        snprintf(filename, sizeof(filename), "dct8x8_%d.dat", threads);
+        save_double_matrix(output, lines, columns, filename);
+
+        double max_error, rms_error;
+        compare_outputs(reference, output, size, &max_error, &rms_error);
+        printf("\nError versus DCT1D_serial blocks: max %.3e | RMS %.3e", max_error, rms_error);
+        if (max_error > DCT_TOLERANCE) {
+            printf("\nERROR! 8x8 block DCT does NOT match the direct DCT with %d threads!", threads);
+            errors++;
+        }
+        compare_outputs(matrix, restored, size, &max_error, &rms_error);
+        printf("\nRound trip error (DCT-III of DCT-II): max %.3e | RMS %.3e", max_error, rms_error);
+        if (max_error <= DCT_TOLERANCE) {
+            printf("\nOK! Inverse 8x8 block DCT (%d threads) restores the matrix!", threads);
+        } else {
+            printf("\nERROR! Inverse 8x8 block DCT does NOT restore the matrix with %d threads!", threads);
+            errors++;
+        }
+        free_aligned_memory(output);
+        free_aligned_memory(restored);
+    }
+
+    free_aligned_memory(matrix);
+    free_aligned_memory(reference);
+    printf("\n");
+    return errors > 0;
+}
+
+
+// Planos de tamanho size: a DCT-II do plano é comparada com DCT1D_serial e
+// a DCT-III precisa devolver o vetor. Depois um lote de vetores passa por
+// DCT1D_fast, que monta as tabelas a cada chamada, e pelo plano com 1, 2 e
+// 4 threads.
+int run_plan(long int size, int algorithm, int bind_policy) {
+    double *vector = load_or_generate_vector(size);
+    double *output_serial = (double*)malloc(sizeof(double) * size);
+    double *output = (double*)malloc(sizeof(double) * size);
+    double *restored = (double*)malloc(sizeof(double) * size);
+
+    printf("\nRunning serial DCT 1D...");
+    double start = omp_get_wtime();
+    DCT1D_serial(vector, output_serial, size);
+    printf("\nSerial time: %.6f seconds\n", omp_get_wtime() - start);
+
+    start = omp_get_wtime();
+    dct_plan_t *forward = dct_plan_create(size, DCT_TYPE_II, 4, algorithm);
+    dct_plan_t *inverse = dct_plan_create(size, DCT_TYPE_III, 4, algorithm);
+    double time_plan = omp_get_wtime() - start;
+    if (forward == NULL || inverse == NULL) {
+        fprintf(stderr, "Could not create the DCT plans for N = %ld\n", size);
+        return 1;
+    }
+    printf("\nPlan time (DCT-II and DCT-III): %.6f seconds", time_plan);
+    printf("\nAlgorithm: %s", algorithm_names[dct_plan_algorithm(forward)]);
+
+    int errors = 0;
+    double max_error, rms_error;
+    dct_plan_execute(forward, vector, output);
+    dct_plan_execute(inverse, output, restored);
+    compare_outputs(output_serial, output, size, &max_error, &rms_error);
+    printf("\nError versus libm (relative to max |X[k]|): max %.3e | RMS %.3e", max_error, rms_error);
+    if (max_error > DCT_TOLERANCE) {
+        printf("\nERROR! Plan output does NOT match the serial DCT!");
+        errors++;
+    }
+    compare_outputs(vector, restored, size, &max_error, &rms_error);
+    printf("\nRound trip error (DCT-III of DCT-II): max %.3e | RMS %.3e", max_error, rms_error);
+    if (max_error > DCT_TOLERANCE) {
+        printf("\nERROR! The DCT-III plan does NOT restore the vector!");
+        errors++;
+    }
+
+    long int count = PLAN_BATCH_ELEMENTS / size > 0 ? PLAN_BATCH_ELEMENTS / size : 1;
+    double *batch = (double*)allocate_aligned_memory(sizeof(double) * count * size);
+    double *batch_output = (double*)allocate_aligned_memory(sizeof(double) * count * size);
+    for (long int v = 0; v < count; v++)
+        memcpy(&batch[v * size], vector, sizeof(double) * size);
+
+    printf("\n----------------------------------------------\n");
+    printf("\nRunning DCT1D_fast on %ld vectors...", count);
+    start = omp_get_wtime();
+    for (long int v = 0; v < count; v++)
+        DCT1D_fast(&batch[v * size], &batch_output[v * size], size);
+    double time_unplanned = omp_get_wtime() - start;
+    printf("\nUnplanned time: %.6f seconds | %.3f us per transform\n", time_unplanned,
+           time_unplanned / count * 1e6);
+
+    for (int threads = 1; threads <= 4; threads *= 2) {
+        printf("\n----------------------------------------------\n");
+        set_threads(threads, bind_policy);
+        dct_plan_t *plan = dct_plan_create(size, DCT_TYPE_II, threads, dct_plan_algorithm(forward));
+        if (plan == NULL) {
+            printf("\nERROR! Could not create the DCT plan with %d threads!", threads);
+            errors++;
+            continue;
+        }
+        printf("\nRunning planned DCT on %ld vectors (%d threads)...", count, threads);
+        start = omp_get_wtime();
+        dct_plan_execute_many(plan, batch, batch_output, count);
+        double time_planned = omp_get_wtime() - start;
+        printf("\nPlanned time (%d threads): %.6f seconds | %.3f us per transform", threads,
+               time_planned, time_planned / count * 1e6);
+        printf("\nSpeedup versus unplanned (%d threads): %.3f", threads, time_unplanned / time_planned);
+        int equal = 1;
+        for (long int v = 0; v < count && equal; v++)
+            equal = memcmp(&batch_output[v * size], output, sizeof(double) * size) == 0;
+        if (equal) {
+            printf("\nOK! Every vector of the batch matches the single execution!");
+        } else {
+            printf("\nERROR! Batch outputs differ from the single execution with %d threads!", threads);
+            errors++;
+        }
+        dct_plan_destroy(plan);
+    }
+
+    dct_plan_destroy(forward);
+    dct_plan_destroy(inverse);
+    free_aligned_memory(batch);
+    free_aligned_memory(batch_output);
+    free_aligned_memory(vector);
+    free(output_serial);
+    free(output);
+    free(restored);
+    printf("\n");
+    return errors > 0;
+}
+
+
+int main(int argc, char **argv) {
+    srand(time(NULL));
+    int bind_policy = BIND_NONE;
+    int implementation = TYPE_PARALLEL;
+    int algorithm = DCT_ALGORITHM_AUTO;
+    long int size = SIZE;
+    long int lines = FRAME_LINES, columns = FRAME_COLUMNS;
+    int huge_page_mode = HUGE_PAGES_NONE;
+    int opt;
+    while ((opt = getopt(argc, argv, "a:b:c:i:l:m:n:p:")) != -1) {
+        switch (opt) {
+        case 'a':
+            if (strcmp(optarg, "auto") == 0) {
+                algorithm = DCT_ALGORITHM_AUTO;
+                break;
+            }
+            for (algorithm = DCT_ALGORITHM_FAST; algorithm >= DCT_ALGORITHM_TABLE; algorithm--) {
+                if (strcmp(algorithm_names[algorithm], optarg) == 0)
+                    break;
+            }
+            if (algorithm < DCT_ALGORITHM_TABLE) {
+                fprintf(stderr, "Unknown plan algorithm: %s\n", optarg);
+                return 1;
+            }
+            break;
+        case 'b':
+            bind_policy = parse_bind_policy(optarg);
+            if (bind_policy < 0) {
+                fprintf(stderr, "Unknown binding policy: %s\n", optarg);
+                return 1;
+            }
+            break;
+        case 'c':
+            columns = atol(optarg);
+            break;
+        case 'i':
+            if (strcmp(optarg, "auto") == 0) {
+                simd_isa = SIMD_AUTO;
+                break;
+            }
+            for (simd_isa = SIMD_AVX512; simd_isa >= SIMD_SCALAR; simd_isa--) {
+                if (strcmp(isa_names[simd_isa], optarg) == 0)
+                    break;
+            }
+            if (simd_isa < SIMD_SCALAR) {
+                fprintf(stderr, "Unknown instruction set: %s\n", optarg);
+                return 1;
+            }
+            if (simd_isa > best_simd_isa()) {
+                fprintf(stderr, "Instruction set not supported by this CPU: %s\n", optarg);
+                return 1;
+            }
+            break;
+        case 'l':
+            lines = atol(optarg);
+            break;
+        case 'm':
+            implementation = parse_implementation(optarg);
+            if (implementation < 0) {
+                fprintf(stderr, "Unknown implementation: %s\n", optarg);
+                return 1;
+            }
+            break;
+        case 'n':
+            size = atol(optarg);
+            break;
+        case 'p':
+            huge_page_mode = parse_huge_page_mode(optarg);
+            if (huge_page_mode < 0) {
+                fprintf(stderr, "Unknown huge page mode: %s\n", optarg);
+                return 1;
+            }
+            break;
+        default:
+            fprintf(stderr, "Usage: %s [-m parallel|recurrence|blocked|fast|2d|8x8|plan] [-n size] [-b none|compact|scatter]\n"
+                "          [-i auto|scalar|avx2|avx512] [-l 2d lines] [-c 2d columns]\n"
+                "          [-a auto|table|fast] [-p none|thp|explicit]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    // Vale para todos os vetores e matrizes alocados pela LibPPC daqui em diante
+    set_huge_page_mode(huge_page_mode);
+
+    if (implementation == TYPE_RECURRENCE)
+        return run_variant("recurrence", dct_recurrence, size, bind_policy);
+    if (implementation == TYPE_BLOCKED)
+        return run_variant("blocked", dct_blocked, size, bind_policy);
+    if (implementation == TYPE_FAST)
+        return run_variant("fast", dct_fast, size, bind_policy);
+    if (implementation == TYPE_2D) {
+        if (lines < 1 || columns < 1) {
+            fprintf(stderr, "Invalid matrix shape: %ld x %ld\n", lines, columns);
+            return 1;
+        }
+        return run_2d(lines, columns, bind_policy);
+    }
+    if (implementation == TYPE_8X8) {
+        if (lines < 8 || columns < 8 || lines % 8 != 0 || columns % 8 != 0) {
+            fprintf(stderr, "Invalid matrix shape for 8x8 blocks: %ld x %ld\n", lines, columns);
+            return 1;
+        }
+        return run_8x8(lines, columns, bind_policy);
+    }
+    if (implementation == TYPE_PLAN)
+        return run_plan(size, algorithm, bind_policy);
+
+    double *vector, *output_serial, *output_2, *output_4;
+    vector = load_or_generate_vector(size);
+    output_serial = (double*)malloc(sizeof(double) * size);
 
     double start, end, time_serial = 0, time_parallel_2 = 0, time_parallel_4 = 0;
+    long long tlb_misses;
+    print_huge_page_mode();
     printf("\nRunning serial DCT 1D...");
+    start_dtlb_miss_counters();
     start = omp_get_wtime();
-    DCT1D_serial(vector, output_serial, SIZE);
+    DCT1D_serial(vector, output_serial, size);
     end = omp_get_wtime();
+    tlb_misses = stop_dtlb_miss_counters();
     time_serial = end - start;
-    printf("\nSerial time: %.6f seconds\n", time_serial);
-    save_double_vector(output_serial, SIZE, "dct_serial.dat");
+    printf("\nSerial time: %.6f seconds", time_serial);
+    print_dtlb_misses(tlb_misses);
+    printf("\n");
+    save_double_vector(output_serial, size, "dct_serial.dat");
 
     printf("\n----------------------------------------------\n");
 
-    omp_set_num_threads(2);
+    set_threads(2, bind_policy);
+    // Cada thread toca primeiro o trecho de output que vai escrever
+    output_2 = allocate_double_vector_first_touch(size);
     printf("\nRunning parallel DCT 1D (2 threads)...");
+    start_dtlb_miss_counters();
     start = omp_get_wtime();
-    DCT1D_parallel(vector, output_2, SIZE);
+    DCT1D_parallel(vector, output_2, size);
     end = omp_get_wtime();
+    tlb_misses = stop_dtlb_miss_counters();
     time_parallel_2 = end - start;
-    printf("\nParallel time (2 threads): %.6f seconds\n", time_parallel_2);
-    save_double_vector(output_2, SIZE, "dct_parallel_2.dat");
+    printf("\nParallel time (2 threads): %.6f seconds", time_parallel_2);
+    print_dtlb_misses(tlb_misses);
+    printf("\n");
+    print_omp_thread_placement();
+    print_numa_placement(output_2, sizeof(double) * size, "output_2");
+    printf("\n");
+    save_double_vector(output_2, size, "dct_parallel_2.dat");
     double speedup_2 = time_serial / time_parallel_2;
     double eficiencia_2 = speedup_2 / 2.0;
     printf("\nSpeedup (2 threads): %.3f", speedup_2);
@@ -98,14 +702,23 @@ int main(int argc, char **argv) {
 
     printf("\n----------------------------------------------\n");
 
-    omp_set_num_threads(4);
+    set_threads(4, bind_policy);
+    // Cada thread toca primeiro o trecho de output que vai escrever
+    output_4 = allocate_double_vector_first_touch(size);
     printf("\nRunning parallel DCT 1D (4 threads)...");
+    start_dtlb_miss_counters();
     start = omp_get_wtime();
-    DCT1D_parallel(vector, output_4, SIZE);
+    DCT1D_parallel(vector, output_4, size);
     end = omp_get_wtime();
+    tlb_misses = stop_dtlb_miss_counters();
     time_parallel_4 = end - start;
-    printf("\nParallel time (4 threads): %.6f seconds\n", time_parallel_4);
-    save_double_vector(output_4, SIZE, "dct_parallel_4.dat");
+    printf("\nParallel time (4 threads): %.6f seconds", time_parallel_4);
+    print_dtlb_misses(tlb_misses);
+    printf("\n");
+    print_omp_thread_placement();
+    print_numa_placement(output_4, sizeof(double) * size, "output_4");
+    printf("\n");
+    save_double_vector(output_4, size, "dct_parallel_4.dat");
     double speedup_4 = time_serial / time_parallel_4;
     double eficiencia_4 = speedup_4 / 4.0;
     printf("\nSpeedup (4 threads): %.3f", speedup_4);
@@ -131,10 +744,10 @@ int main(int argc, char **argv) {
         printf("\nERROR! Outputs are NOT equal for 4 threads!");
     }
 
-    free(vector);
+    free_aligned_memory(vector);
     free(output_serial);
-    free(output_2);
-    free(output_4);
+    free_aligned_memory(output_2);
+    free_aligned_memory(output_4);
     printf("\n");
     return 0;
 }